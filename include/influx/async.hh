@@ -0,0 +1,222 @@
+#ifndef INFLUX__ASYNC_HH_
+#define INFLUX__ASYNC_HH_
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <influx/types.hh>
+
+namespace influx {
+
+namespace transport {
+    class HttpClient;
+}
+
+class EventLoop;
+
+template <typename T>
+class Task;
+
+namespace detail {
+    template <typename T>
+    class TaskPromiseBase {
+    public:
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+            {
+                if (auto continuation = handle.promise().continuation_) {
+                    return continuation;
+                }
+                return std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+        void unhandled_exception() { exception_ = std::current_exception(); }
+
+    protected:
+        void rethrow() const
+        {
+            if (exception_) {
+                std::rethrow_exception(exception_);
+            }
+        }
+
+    private:
+        template <typename U>
+        friend class ::influx::Task;
+
+        std::coroutine_handle<> continuation_;
+        std::exception_ptr exception_;
+    };
+
+    template <typename T>
+    class TaskPromise : public TaskPromiseBase<T> {
+    public:
+        Task<T> get_return_object();
+        void return_value(T value) { value_.emplace(std::move(value)); }
+
+        T result()
+        {
+            this->rethrow();
+            return std::move(*value_);
+        }
+
+    private:
+        std::optional<T> value_;
+    };
+
+    template <>
+    class TaskPromise<void> : public TaskPromiseBase<void> {
+    public:
+        Task<void> get_return_object();
+        void return_void() {}
+        void result() { this->rethrow(); }
+    };
+}
+
+/* Lazily started coroutine producing a T. A Task only runs once awaited, or
+ * once handed to an EventLoop. Coroutine member functions of this library
+ * capture `this`: the object they are called on must outlive the Task. */
+template <typename T = void>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    Task(Task&& other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr))
+    {
+    }
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task()
+    {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle_.promise().continuation_ = awaiting;
+        return handle_;
+    }
+
+    T await_resume() { return handle_.promise().result(); }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : handle_(handle)
+    {
+    }
+
+    friend promise_type;
+    friend class EventLoop;
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+    template <typename T>
+    Task<T> TaskPromise<T>::get_return_object()
+    {
+        return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+    }
+
+    inline Task<void> TaskPromise<void>::get_return_object()
+    {
+        return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+    }
+}
+
+/* Minimal single-threaded executor. Drives every HTTP transfer awaited by the
+ * tasks it runs through one non-blocking curl multi handle, so any number of
+ * requests can be in flight from a single thread. */
+class EventLoop {
+public:
+    EventLoop();
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+    ~EventLoop();
+
+    /* Schedule task to start on the next Run(). May be called from within a
+     * running task. */
+    void Spawn(Task<void>&& task);
+
+    /* Run until every spawned task has completed. Rethrows the first exception
+     * that escaped a spawned task. */
+    void Run();
+
+    /* Spawn task, Run(), and return its result */
+    template <typename T>
+    T Run(Task<T>&& task);
+
+    /* Loop currently running on this thread, or nullptr */
+    static EventLoop* Current();
+
+private:
+    struct TransferAwaiter {
+        EventLoop& loop;
+        void* handle;
+        int result = 0;
+        std::coroutine_handle<> waiting = nullptr;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> awaiting);
+        int await_resume() const noexcept { return result; }
+    };
+
+    /* Await completion of the curl easy handle, returning its CURLcode */
+    TransferAwaiter transfer(void* handle);
+    friend class transport::HttpClient;
+
+private:
+    struct Priv;
+    std::unique_ptr<Priv> d_;
+};
+
+template <typename T>
+T EventLoop::Run(Task<T>&& task)
+{
+    if constexpr (std::is_void_v<T>) {
+        Spawn(std::move(task));
+        Run();
+    } else {
+        std::optional<T> result;
+        Spawn([](Task<T> task, std::optional<T>& result) -> Task<void> {
+            result.emplace(co_await std::move(task));
+        }(std::move(task), result));
+        Run();
+        return std::move(*result);
+    }
+}
+
+} // namespace
+
+#endif
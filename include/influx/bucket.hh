@@ -1,20 +1,101 @@
 #ifndef INFLUX__BUCKET_HH_
 #define INFLUX__BUCKET_HH_
 
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <vector>
 
+#include <influx/async.hh>
 #include <influx/measurement.hh>
+#include <influx/point_view.hh>
 #include <influx/client.hh>
 
 namespace influx {
 
+/* Order in which buffered measurements are sent on Flush. Series groups points
+ * by measurement name and tag set, then by timestamp, which InfluxDB ingests and
+ * compresses more efficiently than interleaved series. */
+enum class FlushOrder {
+    Arrival,
+    Series
+};
+
+/* Settings of the adaptive batching controller. While writes complete within
+ * targetLatency the batch size grows by increase points; slower writes shrink
+ * it by the decrease factor. 429 and 503 responses also shrink it and pause
+ * automatic flushes for an exponentially growing backoff. Once the oldest
+ * buffered point has waited maxDelay, Write flushes a partial batch too; there
+ * is no timer, so points wait longer while nothing is written. 0 only flushes
+ * full batches. */
+struct AdaptiveBatching {
+    std::size_t initialBatchSize = 5000;
+    std::size_t minBatchSize = 100;
+    std::size_t maxBatchSize = 100000;
+    std::size_t increase = 1000;
+    double decrease = 0.5;
+    std::chrono::milliseconds targetLatency{500};
+    std::chrono::milliseconds initialBackoff{100};
+    std::chrono::milliseconds maxBackoff{30000};
+    std::chrono::milliseconds maxDelay{0};
+};
+
+/* What Write does when accepting a point would exceed the buffer capacity.
+ * Block waits up to blockTimeout for a concurrent Flush to make room, then
+ * throws BufferFullError. DropOldest evicts buffered points, DropNewest
+ * discards the incoming one and Flush sends the buffer synchronously. */
+enum class OverflowPolicy {
+    Block,
+    DropOldest,
+    DropNewest,
+    Flush
+};
+
+/* Capacity of a Bucket's write buffer. Points being flushed still count
+ * against it until the server accepts them. Bytes are estimated from the line
+ * protocol size of each point. 0 means unbounded. */
+struct BufferLimits {
+    std::size_t maxPoints = 0;
+    std::size_t maxBytes = 0;
+    OverflowPolicy policy = OverflowPolicy::Block;
+    std::chrono::milliseconds blockTimeout{1000};
+};
+
+/* Settings of Bucket::Import. The input is cut at line boundaries into
+ * request bodies of at most batchBytes (a longer line goes alone), posted over
+ * up to concurrency connections and gzip-compressed at compressionLevel, 1
+ * (fastest) to 9, unless it is 0. */
+struct ImportOptions {
+    std::size_t batchBytes = 8 * 1024 * 1024;
+    std::size_t concurrency = 4;
+    int compressionLevel = 1;
+};
+
+struct ImportStats {
+    std::size_t bytes = 0;
+    std::size_t sentBytes = 0;  // after compression
+    std::size_t requests = 0;
+};
+
+struct BatchingState {
+    std::size_t batchSize = 0;
+    std::chrono::milliseconds lastLatency{0};
+    std::chrono::milliseconds backoff{0};
+    std::size_t throttledWrites = 0;
+};
+
+/* Handle to the write pipeline of a server-side bucket: its buffer, settings
+ * and connection. Copies are cheap and share the pipeline, so points written
+ * through one are flushed by any other; the pipeline lives as long as its last
+ * handle. An Influx hands out handles to the same pipeline for a given bucket
+ * while one is alive, with the settings it had; the Influx's settings are
+ * copied when a pipeline is created. Moved-from handles are null. */
 class Bucket {
 public:
     Bucket();
-    Bucket(Bucket&& other);
-    Bucket& operator=(Bucket&& other);
+    Bucket(Bucket&& other) noexcept;
+    Bucket& operator=(Bucket&& other) noexcept;
     Bucket(const Bucket& other);
     Bucket& operator=(const Bucket& other);
 
@@ -25,10 +106,70 @@ public:
     bool operator!=(const Bucket& other) const;
 
     void Write(const Measurement& seasurement);
+    void Write(Measurement&& measurement);
     void Write(const std::vector<Measurement>& seasurements);
+
+    /* Serialize point into the buffer right away, without copying what it
+     * borrows. Such points are sent after buffered Measurements in a flush and
+     * are not reordered by FlushOrder::Series. */
+    void Write(const PointView& point);
     void Flush();
 
+    /* Post a line protocol file (precision=ns) as-is, bypassing the buffer.
+     * The file is memory-mapped rather than read. Stops at the first failed
+     * request and rethrows its error once in-flight requests are done; lines
+     * already accepted stay written. */
+    ImportStats Import(const std::string& path, const ImportOptions& options = {});
+    ImportStats ImportLines(std::string_view lines, const ImportOptions& options = {});
+
+    /* Awaitable Flush, see EventLoop, sending batches of the adaptive batch
+     * size in turn when enabled. Points written while it is in flight are kept
+     * for the next flush; on failure the batch is put back in front. Request
+     * options set while it runs apply from the next flush on. */
+    Task<void> FlushAsync();
+
+    void SetFlushOrder(FlushOrder order);
+    FlushOrder flushOrder() const;
+
+    /* Upper bound on threads serializing a large batch on Flush. Defaults to
+     * the number of hardware threads; 1 serializes on the calling thread. */
+    void SetSerializationThreads(std::size_t threads);
+    std::size_t serializationThreads() const;
+
+    /* With adaptive batching, Write flushes automatically once a batch worth of
+     * points is buffered, or the oldest has waited maxDelay (throttled batches
+     * stay buffered), and Flush sends the
+     * buffer in requests of at most the current batch size. */
+    void EnableAdaptiveBatching(const AdaptiveBatching& options = {});
+    void DisableAdaptiveBatching();
+    std::optional<BatchingState> batchingState() const;
+
+    /* Bounds the write buffer. Write and Flush may then be called from
+     * different threads. */
+    void SetBufferLimits(const BufferLimits& limits);
+    BufferLimits bufferLimits() const;
+
+    /* Timeouts and cancellation of this bucket's requests, initially those
+     * of the Influx it came from */
+    void SetRequestOptions(const RequestOptions& options);
+    RequestOptions requestOptions() const;
+
+    /* How Flush and Import send writes, see transport::WriteTransport */
+    void SetWriteTransport(transport::WriteTransport transport);
+    transport::WriteTransport writeTransport() const;
+
+    /* Keep up to size measurements once flushed, instead of freeing them, for
+     * Acquire to hand out again. 0, the default, disables pooling. */
+    void SetMeasurementPoolSize(std::size_t size);
+    std::size_t measurementPoolSize() const;
+
+    /* A measurement named name, reset from the pool when it is not empty: its
+     * strings keep their storage, see Measurement::Reset. Write it back with
+     * Write(Measurement&&) for the cycle to allocate nothing. */
+    Measurement Acquire(std::string_view name, Timestamp timestamp = Now());
+
     std::size_t BufferedMeasurementsCount() const;
+    std::size_t DroppedMeasurementsCount() const;
 
     std::string id() const;
     std::string name() const;
@@ -36,20 +177,32 @@ public:
     bool is_system_bucket() const;
 
 private:
+    struct Priv;
+
     Bucket(const std::string& id, const std::string& name, const std::string& orgId, transport::HttpClient&& client);
+    explicit Bucket(std::shared_ptr<Priv> d);
     friend class Influx;
 
+    /* Throws NullBucketError if this handle is null */
+    Priv& priv() const;
+
 private:
-    struct Priv;
-    std::unique_ptr<Priv> d_;
+    std::shared_ptr<Priv> d_;
 };
 
 class NullBucketError : public InfluxError {
     const char* what() const throw() override { return "Cannot act on null bucket"; }
 };
 
+class BufferFullError : public InfluxError {
+public:
+    const char* what() const throw() override { return "Bucket buffer is full"; }
+};
+
 } // namespace
 
 influx::Bucket& operator<<(influx::Bucket& bucket, const influx::Measurement& measurement);
+influx::Bucket& operator<<(influx::Bucket& bucket, influx::Measurement&& measurement);
+influx::Bucket& operator<<(influx::Bucket& bucket, const influx::PointView& point);
 
 #endif
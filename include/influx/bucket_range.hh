@@ -0,0 +1,70 @@
+#ifndef INFLUX__BUCKET_RANGE_HH_
+#define INFLUX__BUCKET_RANGE_HH_
+
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include <influx/client.hh>
+
+namespace influx {
+
+/* Bucket metadata as listed by the API, without a connection of its own. Use
+ * Influx::GetBucket to turn it into a writable Bucket. */
+struct BucketInfo {
+    std::string id;
+    std::string name;
+    std::string orgId;
+
+    bool is_system_bucket() const;
+};
+
+/* Single-pass range over every bucket of an organization. Pages are fetched
+ * on demand and the following page is prefetched in the background while the
+ * current one is being consumed. A page that fails to load is thrown from
+ * begin or operator++, which leaves the range at its end. */
+class BucketRange {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = BucketInfo;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const BucketInfo*;
+        using reference = const BucketInfo&;
+
+        iterator() = default;
+
+        reference operator*() const;
+        pointer operator->() const;
+        iterator& operator++();
+        void operator++(int);
+
+        bool operator==(std::default_sentinel_t) const;
+
+    private:
+        explicit iterator(BucketRange* range);
+        friend class BucketRange;
+
+        BucketRange* range_ = nullptr;
+    };
+
+    BucketRange(BucketRange&& other);
+    BucketRange& operator=(BucketRange&& other);
+    ~BucketRange();
+
+    iterator begin();
+    std::default_sentinel_t end() const;
+
+private:
+    BucketRange(transport::HttpClient&& client, std::size_t pageSize);
+    friend class Influx;
+
+private:
+    struct Priv;
+    std::unique_ptr<Priv> d_;
+};
+
+} // namespace
+
+#endif
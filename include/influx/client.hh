@@ -1,12 +1,17 @@
 #ifndef INFLUX__CLIENT_HH_
 #define INFLUX__CLIENT_HH_
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <utility>
 #include <unordered_map>
+#include <vector>
 
+#include <influx/async.hh>
+#include <influx/request_options.hh>
 #include <influx/types.hh>
 
 namespace influx::transport {
@@ -23,14 +28,86 @@ struct HttpResponse {
     std::string body;
 };
 
+/* HTTP version of requests. Auto leaves it to libcurl: HTTP/2 over TLS
+ * when the server offers it. Http2 also asks plaintext servers to upgrade,
+ * and Http2PriorKnowledge speaks HTTP/2 (h2c) to them right away. */
+enum class HttpVersion {
+    Auto,
+    Http1_1,
+    Http2,
+    Http2PriorKnowledge
+};
+
+/* Transport of POST requests that do not stream their response. Native
+ * sends them over a persistent plaintext HTTP/1.1 connection of the client's
+ * own, writing the request head and body chunks with one scatter-gather
+ * system call instead of copying them through libcurl's buffers. It suits
+ * line protocol writes to http:// and unix:// hosts; other requests, async
+ * ones and https:// hosts keep using libcurl. */
+enum class WriteTransport {
+    Curl,
+    Native
+};
+
+/* Receives a response body piece by piece, as it arrives */
+using BodySink = std::function<void(std::string_view)>;
+
+/* Endpoint and headers resolved once by HttpClient::Prepare, for requests
+ * sent over and over: the URL and header list are built up front and shared
+ * by copies. Valid with the client that prepared it and its copies. */
+class RequestTemplate {
+public:
+    RequestTemplate();
+
+    explicit operator bool() const;
+
+private:
+    struct Priv;
+    std::shared_ptr<const Priv> d_;
+    friend class HttpClient;
+};
+
 class HttpClient {
 public:
     HttpClient();
+
+    /* Takes over other's connections; other may then only be destroyed */
     HttpClient(HttpClient&& other);
     HttpClient(const HttpClient& other);
+
+    /* host is a URL prefix such as http://localhost:8086, or unix:// followed
+     * by the path of a Unix domain socket the server listens on, e.g.
+     * unix:///var/run/influxdb.sock */
     HttpClient(const std::string& host, const std::string& org, const std::string& token);
     ~HttpClient();
 
+    /* Limits applied to every request of this client, and of its copies made
+     * afterwards. A RequestScope on the calling thread overrides them. */
+    void SetDefaultOptions(const RequestOptions& options);
+    const RequestOptions& defaultOptions() const;
+
+    /* Offer every encoding libcurl can decode (gzip, deflate...) in
+     * Accept-Encoding. Responses are then decompressed as they arrive, before
+     * reaching a BodySink. Enabled by default. */
+    void SetResponseCompression(bool enabled);
+    bool responseCompression() const;
+
+    /* Copies of a client share its connection, DNS and TLS session caches,
+     * so requests to the same host reuse connections whichever copy sends
+     * them; over HTTP/2, transfers of an EventLoop are multiplexed. */
+    void SetHttpVersion(HttpVersion version);
+    HttpVersion httpVersion() const;
+
+    /* Throws InfluxError when setting Native for an https:// host. Copies
+     * keep the setting but open their own connection. */
+    void SetWriteTransport(WriteTransport transport);
+    WriteTransport writeTransport() const;
+
+    RequestTemplate Prepare(
+        const std::string& endpoint,
+        const std::unordered_map<std::string, std::string>& headers = {}
+    ) const;
+
     HttpResponse Get(
         const std::string& endpoint,
         const std::unordered_map<std::string, std::string>& headers = {}
@@ -38,23 +115,67 @@ public:
 
     HttpResponse Post(
         const std::string& endpoint,
-        const std::string& body,
+        std::string_view body,
+        const std::unordered_map<std::string, std::string>& headers = {}
+    );
+
+    /* Post the concatenation of chunks as a single body, without joining them */
+    HttpResponse Post(
+        const std::string& endpoint,
+        const std::vector<std::string>& chunks,
+        const std::unordered_map<std::string, std::string>& headers = {}
+    );
+
+    /* Post body and hand the response body to sink as it arrives instead of
+     * buffering it, returning the status. Error responses are still buffered
+     * and thrown. An exception thrown by sink aborts the transfer and is
+     * rethrown. */
+    int Post(
+        const std::string& endpoint,
+        std::string_view body,
+        const BodySink& sink,
         const std::unordered_map<std::string, std::string>& headers = {}
     );
 
+    HttpResponse Post(const RequestTemplate& request, std::string_view body);
+    HttpResponse Post(const RequestTemplate& request, const std::vector<std::string>& chunks);
+    int Post(const RequestTemplate& request, std::string_view body, const BodySink& sink);
+
     HttpResponse Delete(
         const std::string& endpoint,
-        const std::string& body = "",
+        std::string_view body = "",
         const std::unordered_map<std::string, std::string>& headers = {}
     );
 
+    /* Non-blocking variants, driven by the EventLoop they are awaited from */
+    Task<HttpResponse> GetAsync(
+        std::string endpoint,
+        std::unordered_map<std::string, std::string> headers = {}
+    );
+
+    Task<HttpResponse> PostAsync(
+        std::string endpoint,
+        std::vector<std::string> chunks,
+        std::unordered_map<std::string, std::string> headers = {}
+    );
+
+    Task<HttpResponse> PostAsync(
+        RequestTemplate request,
+        std::vector<std::string> chunks
+    );
 
 private:
     HttpResponse Perform(
         const Verb verb,
-        const std::string& endpoint,
-        const std::string& body,
-        const std::unordered_map<std::string, std::string>& headers
+        const RequestTemplate& request,
+        const std::vector<std::string_view>& body,
+        const BodySink* sink = nullptr
+    );
+
+    Task<HttpResponse> PerformAsync(
+        const Verb verb,
+        RequestTemplate request,
+        std::vector<std::string> body
     );
 
 private:
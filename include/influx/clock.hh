@@ -0,0 +1,33 @@
+#ifndef INFLUX__CLOCK_HH_
+#define INFLUX__CLOCK_HH_
+
+#include <influx/types.hh>
+
+namespace influx {
+
+/* Where Now() reads the time from. System calls Clock::now(); Coarse reads
+ * CLOCK_REALTIME_COARSE where available (a few milliseconds of resolution,
+ * no syscall); Cached reads a value refreshed every millisecond by a
+ * background thread, running only while this source is selected. */
+enum class TimestampSource {
+    System,
+    Coarse,
+    Cached
+};
+
+/* Process-wide, defaults to System */
+void SetTimestampSource(TimestampSource source);
+TimestampSource timestampSource();
+
+/* Current time from the selected source. Used for default Measurement
+ * timestamps. */
+Timestamp Now();
+
+/* Timestamp of a point left for the server to assign on reception. Pass it
+ * to the Measurement constructor when the actual timestamp is set afterwards,
+ * so the clock is not read at all. */
+inline constexpr Timestamp NoTimestamp = Timestamp::min();
+
+} // namespace
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef INFLUX__DATAGRAM_SINK_HH_
+#define INFLUX__DATAGRAM_SINK_HH_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <influx/measurement.hh>
+#include <influx/point_view.hh>
+
+namespace influx {
+
+/* Settings of a DatagramSink. Lines are packed into datagrams of at most
+ * maxDatagramSize bytes (a longer line goes alone); the default fits a 1500
+ * byte Ethernet MTU once IPv4 and UDP headers are added. batchDatagrams are
+ * handed to the kernel per system call, and Write sends as soon as that many
+ * are full. */
+struct DatagramOptions {
+    std::size_t maxDatagramSize = 1472;
+    std::size_t batchDatagrams = 64;
+};
+
+struct DatagramStats {
+    std::size_t points = 0;
+    std::size_t datagrams = 0;
+    std::size_t bytes = 0;
+    std::size_t failedDatagrams = 0;  // not accepted by the kernel
+};
+
+/* Fire-and-forget line protocol writer for listeners such as Telegraf's
+ * socket_listener, over UDP (udp://host:port) or a Unix datagram socket
+ * (unixgram:///path/to/socket). Nothing acknowledges datagrams: whatever the
+ * network or listener drops is lost silently. Timestamps are in nanoseconds.
+ * Use from one thread at a time. Throws InfluxError if address cannot be
+ * resolved or connected to. Not supported on Windows. */
+class DatagramSink {
+public:
+    DatagramSink();
+    explicit DatagramSink(const std::string& address, const DatagramOptions& options = {});
+    DatagramSink(DatagramSink&& other);
+    DatagramSink& operator=(DatagramSink&& other);
+    ~DatagramSink();
+
+    operator bool() const;
+
+    void Write(const Measurement& measurement);
+    void Write(const std::vector<Measurement>& measurements);
+    void Write(const PointView& point);
+
+    /* Send every buffered line */
+    void Flush();
+
+    std::size_t BufferedBytes() const;
+    DatagramStats stats() const;
+
+private:
+    struct Priv;
+    std::unique_ptr<Priv> d_;
+};
+
+} // namespace
+
+influx::DatagramSink& operator<<(influx::DatagramSink& sink, const influx::Measurement& measurement);
+influx::DatagramSink& operator<<(influx::DatagramSink& sink, const influx::PointView& point);
+
+#endif
@@ -1,8 +1,10 @@
 #ifndef INFLUX__FLUX_PARSER_HH_
 #define INFLUX__FLUX_PARSER_HH_
 
+#include <iosfwd>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
@@ -10,22 +12,104 @@
 
 namespace influx {
 
+/* Immutable string shared by the records holding the same value, such as the
+ * field name of every row of a table. Copies only bump a reference count. */
+class InternedString {
+public:
+    InternedString();
+    InternedString(std::string value);
+    InternedString(const char* value);
+
+    const std::string& str() const { return *value_; }
+    operator const std::string&() const { return *value_; }
+    operator std::string_view() const { return *value_; }
+
+    bool empty() const { return value_->empty(); }
+    std::size_t size() const { return value_->size(); }
+
+    friend bool operator==(const InternedString& lhs, const InternedString& rhs)
+    {
+        return lhs.value_ == rhs.value_ || *lhs.value_ == *rhs.value_;
+    }
+
+    friend bool operator==(const InternedString& lhs, std::string_view rhs) { return *lhs.value_ == rhs; }
+    friend bool operator==(const InternedString& lhs, const char* rhs) { return *lhs.value_ == rhs; }
+    friend bool operator==(const InternedString& lhs, const std::string& rhs) { return *lhs.value_ == rhs; }
+
+private:
+    std::shared_ptr<const std::string> value_;
+};
+
+std::ostream& operator<<(std::ostream& os, const InternedString& string);
+
+/* Tag columns of a record, read-only and shared by the records of a table
+ * with the same values: a table's group key is stored once. */
+class FluxTags {
+public:
+    using Map = std::unordered_map<std::string, std::string>;
+    using key_type = Map::key_type;
+    using mapped_type = Map::mapped_type;
+    using value_type = Map::value_type;
+    using const_iterator = Map::const_iterator;
+    using iterator = const_iterator;
+
+    FluxTags();
+    FluxTags(Map tags);
+
+    const Map& map() const { return *tags_; }
+    operator const Map&() const { return *tags_; }
+
+    const_iterator begin() const { return tags_->begin(); }
+    const_iterator end() const { return tags_->end(); }
+    const_iterator find(const std::string& key) const { return tags_->find(key); }
+    const std::string& at(const std::string& key) const { return tags_->at(key); }
+    std::size_t count(const std::string& key) const { return tags_->count(key); }
+    bool contains(const std::string& key) const { return tags_->contains(key); }
+    std::size_t size() const { return tags_->size(); }
+    bool empty() const { return tags_->empty(); }
+
+    friend bool operator==(const FluxTags& lhs, const FluxTags& rhs)
+    {
+        return lhs.tags_ == rhs.tags_ || *lhs.tags_ == *rhs.tags_;
+    }
+
+    friend bool operator==(const FluxTags& lhs, const Map& rhs) { return *lhs.tags_ == rhs; }
+
+private:
+    std::shared_ptr<const Map> tags_;
+};
+
 struct FluxRecord {
-    std::string name;
+    InternedString name;
     Timestamp start;
     Timestamp stop;
     Timestamp time;
     FieldValue value;
-    std::string field;
-    std::string measurement;
-    std::unordered_map<std::string, std::string> tags;
+    InternedString field;
+    InternedString measurement;
+    FluxTags tags;
 };
 
 using FluxTable = std::vector<FluxRecord>;
 
 class FluxParser {
 public:
+    FluxParser();
+    FluxParser(FluxParser&& other);
+    FluxParser& operator=(FluxParser&& other);
+    ~FluxParser();
+
     std::vector<FluxTable> parse(const std::string& body);
+
+    /* Parse a response handed in arbitrary pieces, as it is received. finish()
+     * returns the tables and resets the parser. Error tables are thrown as
+     * InfluxRemoteError, see FluxCsvReader. */
+    void feed(std::string_view data);
+    std::vector<FluxTable> finish();
+
+private:
+    struct Priv;
+    std::unique_ptr<Priv> d_;
 };
 
 } // namespace
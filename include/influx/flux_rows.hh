@@ -0,0 +1,182 @@
+#ifndef INFLUX__FLUX_ROWS_HH_
+#define INFLUX__FLUX_ROWS_HH_
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <influx/types.hh>
+
+namespace influx {
+
+/* Flux datatype a member type decodes from. Other member types do not
+ * compile. */
+template <typename T> struct FluxType;
+template <> struct FluxType<Timestamp> { static constexpr std::string_view name = "dateTime"; };
+template <> struct FluxType<double> { static constexpr std::string_view name = "double"; };
+template <> struct FluxType<std::int64_t> { static constexpr std::string_view name = "long"; };
+template <> struct FluxType<std::uint64_t> { static constexpr std::string_view name = "unsignedLong"; };
+template <> struct FluxType<bool> { static constexpr std::string_view name = "boolean"; };
+template <> struct FluxType<std::string> { static constexpr std::string_view name = "string"; };
+
+/* Column of a Flux table decoded into member of Row, see Bind */
+template <typename Row, typename T>
+struct FluxColumn {
+    std::string name;
+    T Row::* member;
+};
+
+/* Bind the column named name to member: a Timestamp for a dateTime column,
+ * double for double, std::int64_t for long, std::uint64_t for unsignedLong,
+ * bool for boolean and std::string for string. Null cells leave the member
+ * as Row{} has it. */
+template <typename Row, typename T>
+FluxColumn<Row, T> Bind(std::string name, T Row::* member)
+{
+    return {std::move(name), member};
+}
+
+class FluxColumnError : public InfluxError {
+public:
+    FluxColumnError(const std::string& column, const std::string& message)
+        : column_(column)
+        , message_("column " + column + ": " + message)
+    {
+    }
+
+    const std::string& column() const { return column_; }
+    const char* what() const throw() override { return message_.c_str(); }
+
+private:
+    std::string column_;
+    std::string message_;
+};
+
+/* Splits an annotated CSV response, fed in arbitrary pieces, into table
+ * layouts and rows of raw cells, unquoted. layout is called whenever columns
+ * change, and row once per row with a cell per column, flagged when it starts
+ * a table. Error tables are thrown as InfluxRemoteError. */
+class FluxCsvReader {
+public:
+    struct Column {
+        std::string name;
+        std::string type;
+    };
+
+    using LayoutHandler = std::function<void(const std::vector<Column>& columns)>;
+    using RowHandler = std::function<void(const std::vector<std::string_view>& cells, bool newTable)>;
+
+    FluxCsvReader(LayoutHandler layout, RowHandler row);
+    FluxCsvReader(const FluxCsvReader&) = delete;
+    FluxCsvReader& operator=(const FluxCsvReader&) = delete;
+    ~FluxCsvReader();
+
+    void feed(std::string_view data);
+
+    /* Read a last line lacking its line break */
+    void finish();
+
+private:
+    struct Priv;
+    std::unique_ptr<Priv> d_;
+};
+
+bool FluxTypeMatches(std::string_view type, std::string_view expected);
+
+void DecodeFluxCell(std::string_view cell, Timestamp& out);
+void DecodeFluxCell(std::string_view cell, double& out);
+void DecodeFluxCell(std::string_view cell, std::int64_t& out);
+void DecodeFluxCell(std::string_view cell, std::uint64_t& out);
+void DecodeFluxCell(std::string_view cell, bool& out);
+void DecodeFluxCell(std::string_view cell, std::string& out);
+
+/* Decodes the tables of a query response into Rows, member by member. Columns
+ * are looked up by name once per table layout, which throws FluxColumnError if
+ * one is missing or of another type, before any of its rows is decoded. */
+template <typename Row, typename... T>
+class FluxRowParser {
+public:
+    explicit FluxRowParser(FluxColumn<Row, T>... columns)
+        : columns_(std::move(columns)...)
+        , reader_(
+            [this](const auto& layout) { bind(layout); },
+            [this](const auto& cells, bool newTable) { read(cells, newTable); }
+        )
+    {
+    }
+
+    FluxRowParser(const FluxRowParser&) = delete;
+    FluxRowParser& operator=(const FluxRowParser&) = delete;
+
+    void feed(std::string_view data) { reader_.feed(data); }
+
+    /* Tables read so far. Resets the parser. */
+    std::vector<std::vector<Row>> finish()
+    {
+        reader_.finish();
+        return std::exchange(tables_, {});
+    }
+
+private:
+    using Indices = std::make_index_sequence<sizeof...(T)>;
+
+    void bind(const std::vector<FluxCsvReader::Column>& layout)
+    {
+        bind(layout, Indices());
+    }
+
+    template <std::size_t... I>
+    void bind(const std::vector<FluxCsvReader::Column>& layout, std::index_sequence<I...>)
+    {
+        (bindColumn<I>(layout), ...);
+    }
+
+    template <std::size_t I>
+    void bindColumn(const std::vector<FluxCsvReader::Column>& layout)
+    {
+        using Member = std::tuple_element_t<I, std::tuple<T...>>;
+        const auto& column = std::get<I>(columns_);
+
+        for (std::size_t i = 0; i < layout.size(); i++) {
+            if (layout[i].name == column.name) {
+                if (!FluxTypeMatches(layout[i].type, FluxType<Member>::name)) {
+                    throw FluxColumnError(column.name, "is " + layout[i].type + ", not " + std::string(FluxType<Member>::name));
+                }
+                indices_[I] = i;
+                return;
+            }
+        }
+        throw FluxColumnError(column.name, "missing from query result");
+    }
+
+    void read(const std::vector<std::string_view>& cells, bool newTable)
+    {
+        if (newTable || tables_.empty()) {
+            tables_.emplace_back();
+        }
+
+        Row& row = tables_.back().emplace_back();
+        read(row, cells, Indices());
+    }
+
+    template <std::size_t... I>
+    void read(Row& row, const std::vector<std::string_view>& cells, std::index_sequence<I...>)
+    {
+        ((cells[indices_[I]].empty() ? void() : DecodeFluxCell(cells[indices_[I]], row.*(std::get<I>(columns_).member))), ...);
+    }
+
+    std::tuple<FluxColumn<Row, T>...> columns_;
+    std::array<std::size_t, sizeof...(T)> indices_ = {};
+    std::vector<std::vector<Row>> tables_;
+    FluxCsvReader reader_;
+};
+
+} // namespace
+
+#endif
@@ -3,15 +3,34 @@
 
 #include <chrono>
 #include <memory>
+#include <ostream>
 #include <string>
 #include <vector>
 
+#include <influx/async.hh>
 #include <influx/bucket.hh>
+#include <influx/bucket_range.hh>
 #include <influx/measurement.hh>
 #include <influx/flux_parser.hh>
+#include <influx/flux_rows.hh>
+#include <influx/request_options.hh>
 
 namespace influx {
 
+enum class ExportFormat {
+    AnnotatedCsv,
+    LineProtocol
+};
+
+/* Settings of a range-split Query. The time range is cut into splits equal
+ * sub-ranges queried concurrently. With hedging, once hedgeQuantile (0 to 1)
+ * of them have answered, each still pending is queried a second time: the
+ * first answer wins and the other request is cancelled. */
+struct ParallelQuery {
+    std::size_t splits = 4;
+    double hedgeQuantile = 0;  // 0 disables hedging
+};
+
 class Influx {
 public:
     Influx(Influx&& other);
@@ -26,11 +45,83 @@ public:
     Bucket GetBucketById(const std::string& id);
     Bucket GetBucketByName(const std::string& name);
     std::vector<Bucket> ListBuckets(std::size_t limit = 20, std::size_t offset = 0);
+
+    /* Lazily enumerate all buckets, pageSize (at most 100) at a time */
+    BucketRange Buckets(std::size_t pageSize = 100);
+    Bucket GetBucket(const BucketInfo& info);
     void DeleteBucket(Bucket& name);
 
+    /* Bucket lookups are cached for ttl (60s by default, 0 disables caching).
+     * Creating or deleting a bucket through this instance updates the cache;
+     * changes made by other clients are only seen once entries expire or after
+     * InvalidateBucketCache(). */
+    void SetBucketCacheTtl(const std::chrono::seconds& ttl);
+    void InvalidateBucketCache();
+
+    /* Timeouts and cancellation applied to requests of this instance and of
+     * the bucket pipelines it creates from then on. Nothing times out by
+     * default. Like the settings below, this does not reach pipelines already
+     * alive: further handles to them keep their settings, see Bucket. */
+    void SetRequestOptions(const RequestOptions& options);
+    const RequestOptions& requestOptions() const;
+
+    /* Whether responses, query results above all, may be sent compressed and
+     * decompressed as they stream in, for this instance and the bucket
+     * pipelines it creates from then on. Enabled by default. */
+    void SetResponseCompression(bool enabled);
+    bool responseCompression() const;
+
+    /* HTTP version of requests of this instance and of the bucket pipelines it
+     * creates from then on. They all share connections, see HttpClient. */
+    void SetHttpVersion(transport::HttpVersion version);
+    transport::HttpVersion httpVersion() const;
+
     std::string QueryRaw(const std::string& flux);
     std::vector<FluxTable> Query(const std::string& flux);
 
+    /* Run flux with v.timeRangeStart and v.timeRangeStop bound to [start, stop),
+     * e.g. `from(bucket: "b") |> range(start: v.timeRangeStart, stop: v.timeRangeStop)` */
+    std::string QueryRaw(const std::string& flux, const Timestamp& start, const Timestamp& stop);
+    std::vector<FluxTable> Query(const std::string& flux, const Timestamp& start, const Timestamp& stop);
+
+    /* Query, running flux once per sub-range of [start, stop). Tables of the
+     * same series (result, measurement, field and tags of their first record)
+     * are concatenated in time order, and _start and _stop span the whole
+     * range. flux must not aggregate across sub-range boundaries. Throws
+     * InfluxError unless stop is after start. */
+    std::vector<FluxTable> Query(const std::string& flux, const Timestamp& start, const Timestamp& stop, const ParallelQuery& options);
+
+    /* Query decoding each row straight into a Row, through the members its
+     * columns are bound to, e.g.
+     *
+     *     struct Sample { influx::Timestamp time; double value; std::string host; };
+     *     auto tables = db.Query(flux,
+     *         influx::Bind("_time", &Sample::time),
+     *         influx::Bind("_value", &Sample::value),
+     *         influx::Bind("host", &Sample::host));
+     *
+     * Throws FluxColumnError if a table lacks a bound column or has it of
+     * another type, see FluxRowParser. */
+    template <typename Row, typename... T>
+    std::vector<std::vector<Row>> Query(const std::string& flux, const FluxColumn<Row, T>&... columns)
+    {
+        FluxRowParser<Row, T...> parser(columns...);
+        Export(flux, [&](std::string_view data) { parser.feed(data); });
+        return parser.finish();
+    }
+
+    /* Awaitable QueryRaw and Query, see EventLoop */
+    Task<std::string> QueryRawAsync(std::string flux);
+    Task<std::vector<FluxTable>> QueryAsync(std::string flux);
+
+    /* Run flux and hand its response to sink as it arrives, in constant
+     * memory. LineProtocol converts rows on the fly: they need _measurement,
+     * _field, _value and _time columns, and other columns not starting with
+     * an underscore become tags. */
+    void Export(const std::string& flux, const transport::BodySink& sink, ExportFormat format = ExportFormat::AnnotatedCsv);
+    void Export(const std::string& flux, std::ostream& out, ExportFormat format = ExportFormat::AnnotatedCsv);
+    void Export(const std::string& flux, int fd, ExportFormat format = ExportFormat::AnnotatedCsv);
+
     Bucket operator[](const std::string& name);
 
 private:
@@ -0,0 +1,61 @@
+#ifndef INFLUX__LINE_PROTOCOL_PARSER_HH_
+#define INFLUX__LINE_PROTOCOL_PARSER_HH_
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <influx/point_view.hh>
+#include <influx/types.hh>
+
+namespace influx {
+
+/* Parses line protocol (precision=ns) one point at a time, without copying:
+ * input must outlive the parser. Names, keys and values of the returned point borrow from the input, or
+ * from the parser's own storage when they had to be unescaped; they remain
+ * valid until the next call to Next. Blank lines and comments are skipped and
+ * points without a timestamp get NoTimestamp.
+ *
+ *     LineProtocolParser parser(input);
+ *     while (PointView* point = parser.Next()) {
+ *         bucket << (*point << TagView{"relay", "eu-1"});
+ *     }
+ */
+class LineProtocolParser {
+public:
+    explicit LineProtocolParser(std::string_view input);
+    LineProtocolParser(LineProtocolParser&& other);
+    LineProtocolParser& operator=(LineProtocolParser&& other);
+    ~LineProtocolParser();
+
+    /* Next point, or nullptr at the end of input. Throws LineProtocolError on
+     * malformed lines, after which parsing resumes at the following line. */
+    PointView* Next();
+
+    /* Line number of the point last returned, starting at 1 */
+    std::size_t line() const;
+
+private:
+    struct Priv;
+    std::unique_ptr<Priv> d_;
+};
+
+class LineProtocolError : public InfluxError {
+public:
+    LineProtocolError(std::size_t line, const std::string& message)
+        : line_(line)
+        , message_("line " + std::to_string(line) + ": " + message)
+    {
+    }
+
+    std::size_t line() const { return line_; }
+    const char* what() const throw() override { return message_.c_str(); }
+
+private:
+    std::size_t line_;
+    std::string message_;
+};
+
+} // namespace
+
+#endif
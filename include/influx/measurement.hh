@@ -3,7 +3,11 @@
 
 #include <iostream>
 #include <set>
+#include <string_view>
+#include <vector>
 
+#include <influx/clock.hh>
+#include <influx/point_view.hh>
 #include <influx/types.hh>
 
 namespace influx {
@@ -35,8 +39,15 @@ bool operator<(const influx::Field& lhs, const influx::Field& rhs);
 class Measurement {
 public:
     Measurement() = delete;
-    Measurement(const std::string& name, Timestamp timestamp = Clock::now());
-    Measurement(const std::string& name, const std::set<Tag>& tags, const std::set<Field>& fields, Timestamp timestamp = Clock::now());
+    Measurement(const std::string& name, Timestamp timestamp = Now());
+    Measurement(const std::string& name, const std::set<Tag>& tags, const std::set<Field>& fields, Timestamp timestamp = Now());
+
+    /* Owning copy of point */
+    explicit Measurement(const PointView& point);
+    Measurement(const Measurement& other) = default;
+    Measurement(Measurement&& other) = default;
+    Measurement& operator=(const Measurement& other) = default;
+    Measurement& operator=(Measurement&& other) = default;
     ~Measurement() = default;
 
     bool operator==(const Measurement& other) const;
@@ -46,16 +57,44 @@ public:
     void AddField(const Field& field);
     void SetTimestamp(const Timestamp& timestamp);
 
-    std::string name() const;
+    /* Reuse this measurement for another point: drop its tags and fields but
+     * keep their storage, which SetTag and SetField fill again without
+     * allocating as long as the new strings fit. */
+    void Reset(std::string_view name, Timestamp timestamp = Now());
+
+    /* Set the value of key, in place if it is already there. Unlike AddTag
+     * and AddField, replaces an existing value. */
+    void SetTag(std::string_view key, std::string_view value);
+    void SetField(std::string_view key, const FieldValue& value);
+
+    /* String field values, copied into the storage already there */
+    void SetField(std::string_view key, std::string_view value);
+    void SetField(std::string_view key, const char* value) { SetField(key, std::string_view(value)); }
+    void SetField(std::string_view key, const std::string& value) { SetField(key, std::string_view(value)); }
+
+    const std::string& name() const;
     const std::set<Tag>& tags() const;
     const std::set<Field>& fields() const;
     Timestamp timestamp() const;
 
 private:
+    // Storage of dropped tags and fields, left behind by copies
+    struct Spare {
+        std::vector<std::set<Tag>::node_type> tags;
+        std::vector<std::set<Field>::node_type> fields;
+
+        Spare() = default;
+        Spare(const Spare&) {}
+        Spare(Spare&&) = default;
+        Spare& operator=(const Spare&) { return *this; }
+        Spare& operator=(Spare&&) = default;
+    };
+
     std::string name_;
     std::set<Tag> tags_;
     std::set<Field> fields_;
     Timestamp timestamp_;
+    Spare spare_;
 };
 
 class InvalidMeasurementError: public InfluxError {
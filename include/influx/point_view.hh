@@ -0,0 +1,76 @@
+#ifndef INFLUX__POINT_VIEW_HH_
+#define INFLUX__POINT_VIEW_HH_
+
+#include <array>
+#include <span>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <influx/clock.hh>
+#include <influx/types.hh>
+
+namespace influx {
+
+using FieldValueView = std::variant<double, std::int64_t, std::uint64_t, std::string_view, bool>;
+
+struct TagView {
+    std::string_view key;
+    std::string_view value;
+};
+
+struct FieldView {
+    std::string_view key;
+    FieldValueView value;
+};
+
+/* Non-owning counterpart of Measurement, for points serialized as soon as
+ * they are written. Names, keys and values are borrowed and must outlive the
+ * Bucket::Write call. Tags and fields are kept in the order given, inline up
+ * to INLINE_TAGS and INLINE_FIELDS so building a typical point never
+ * allocates; larger points move to the heap, kept across Reset. Throws
+ * InvalidMeasurementError on invalid keys. */
+class PointView {
+public:
+    static constexpr std::size_t INLINE_TAGS = 32;
+    static constexpr std::size_t INLINE_FIELDS = 32;
+
+    PointView(std::string_view name, Timestamp timestamp = Now());
+
+    /* Start over as an empty point, keeping the storage */
+    void Reset(std::string_view name, Timestamp timestamp = Now());
+
+    void AddTag(const TagView& tag);
+    void AddField(const FieldView& field);
+    void SetTimestamp(const Timestamp& timestamp);
+
+    std::string_view name() const { return name_; }
+    std::span<const TagView> tags() const { return {tagCount_ > INLINE_TAGS ? moreTags_.data() : tags_.data(), tagCount_}; }
+    std::span<const FieldView> fields() const { return {fieldCount_ > INLINE_FIELDS ? moreFields_.data() : fields_.data(), fieldCount_}; }
+    Timestamp timestamp() const { return timestamp_; }
+
+private:
+    std::string_view name_;
+    std::array<TagView, INLINE_TAGS> tags_;
+    std::array<FieldView, INLINE_FIELDS> fields_;
+    std::vector<TagView> moreTags_;
+    std::vector<FieldView> moreFields_;
+    std::size_t tagCount_ = 0;
+    std::size_t fieldCount_ = 0;
+    Timestamp timestamp_;
+};
+
+} // namespace
+
+influx::PointView& operator<<(influx::PointView& point, const influx::TagView& tag);
+influx::PointView& operator<<(influx::PointView& point, const influx::FieldView& field);
+influx::PointView& operator<<(influx::PointView& point, const influx::Timestamp& timestamp);
+
+/* Builders on temporaries return a reference to it rather than a copy, valid
+ * until the end of the full expression: PointView is large and meant to be
+ * written right away. */
+influx::PointView&& operator<<(influx::PointView&& point, const influx::TagView& tag);
+influx::PointView&& operator<<(influx::PointView&& point, const influx::FieldView& field);
+influx::PointView&& operator<<(influx::PointView&& point, const influx::Timestamp& timestamp);
+
+#endif
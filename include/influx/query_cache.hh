@@ -0,0 +1,47 @@
+#ifndef INFLUX__QUERY_CACHE_HH_
+#define INFLUX__QUERY_CACHE_HH_
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <influx/flux_parser.hh>
+#include <influx/influx.hh>
+
+namespace influx {
+
+/* Caches the parsed result of sliding-window queries. The flux must read its
+ * range from v.timeRangeStart and v.timeRangeStop (see Influx::Query). When
+ * the same query is run again over a later window of the same length, only the
+ * interval past the previous stop is queried; its tables are appended to the
+ * matching cached ones and records that fell out of the window are dropped.
+ *
+ * This is only correct for queries whose output rows each depend on a single
+ * point (filters, maps, ...). Windowed aggregates, limits or sorts over the
+ * whole range must be run through Influx::Query. Points written in the past
+ * after they have been cached are not picked up.
+ *
+ * A cache may be shared between threads; queries run without blocking it. */
+class QueryCache {
+public:
+    explicit QueryCache(const Influx& influx);
+    QueryCache(QueryCache&& other);
+    QueryCache& operator=(QueryCache&& other);
+    ~QueryCache();
+
+    /* Query the window [now - window, now) */
+    std::vector<FluxTable> Query(const std::string& flux, const std::chrono::nanoseconds& window);
+    std::vector<FluxTable> Query(const std::string& flux, const Timestamp& start, const Timestamp& stop);
+
+    void Clear();
+    std::size_t size() const;
+
+private:
+    struct Priv;
+    std::unique_ptr<Priv> d_;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef INFLUX__REQUEST_OPTIONS_HH_
+#define INFLUX__REQUEST_OPTIONS_HH_
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+
+#include <influx/types.hh>
+
+namespace influx {
+
+/* Shared flag aborting the requests it is attached to. Copies share the
+ * flag, so Cancel may be called from any thread. */
+class CancellationToken {
+public:
+    CancellationToken()
+        : cancelled_(std::make_shared<std::atomic<bool>>(false))
+    {
+    }
+
+    void Cancel() { *cancelled_ = true; }
+    bool cancelled() const { return *cancelled_; }
+
+private:
+    std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+/* Limits of a request; zero leaves a limit unset. Transfers slower than
+ * lowSpeedLimit bytes per second for lowSpeedTime are aborted as timed out.
+ * A cancelled request is aborted within about a second. */
+struct RequestOptions {
+    std::chrono::milliseconds connectTimeout{0};
+    std::chrono::milliseconds timeout{0};
+    std::size_t lowSpeedLimit = 0;
+    std::chrono::seconds lowSpeedTime{0};
+    std::optional<CancellationToken> cancellation;
+};
+
+/* Overrides the options of every client for requests made by the current
+ * thread while it lives. Limits left unset keep the client's own.
+ *
+ *     CancellationToken token;
+ *     RequestScope scope({.timeout = 2s, .cancellation = token});
+ *     bucket.Flush();
+ */
+class RequestScope {
+public:
+    explicit RequestScope(const RequestOptions& options);
+    RequestScope(const RequestScope&) = delete;
+    RequestScope& operator=(const RequestScope&) = delete;
+    ~RequestScope();
+
+    /* Innermost scope of the current thread, or nullptr */
+    static const RequestOptions* Current();
+
+private:
+    RequestOptions options_;
+    const RequestOptions* previous_;
+};
+
+class TimeoutError : public InfluxError {
+public:
+    const char* what() const throw() override { return "Request timed out"; }
+};
+
+class CancelledError : public InfluxError {
+public:
+    const char* what() const throw() override { return "Request cancelled"; }
+};
+
+} // namespace
+
+#endif
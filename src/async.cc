@@ -0,0 +1,134 @@
+#include <deque>
+#include <unordered_map>
+
+#define NOMINMAX
+#include <curl/curl.h>
+
+#include <influx/async.hh>
+
+#include "util.hh"
+
+namespace influx {
+
+namespace {
+    thread_local EventLoop* current = nullptr;
+
+    // Upper bound on a single wait for socket activity
+    const int POLL_TIMEOUT_MS = 1000;
+}
+
+struct EventLoop::Priv {
+    CURLM* multi = curl_multi_init();
+
+    std::vector<Task<void>> tasks;
+    std::deque<std::coroutine_handle<>> ready;
+    std::unordered_map<CURL*, TransferAwaiter*> transfers;
+
+    void complete()
+    {
+        int pending;
+        while (CURLMsg* message = curl_multi_info_read(multi, &pending)) {
+            if (message->msg != CURLMSG_DONE) {
+                continue;
+            }
+
+            auto it = transfers.find(message->easy_handle);
+            if (it == transfers.end()) {
+                continue;
+            }
+
+            TransferAwaiter* awaiter = it->second;
+            awaiter->result = message->data.result;
+            transfers.erase(it);
+
+            curl_multi_remove_handle(multi, message->easy_handle);
+            ready.push_back(awaiter->waiting);
+        }
+    }
+};
+
+EventLoop::EventLoop()
+    : d_(new Priv)
+{
+}
+
+EventLoop::~EventLoop()
+{
+    // Handles must leave the multi handle before their owning frames free them
+    for (const auto& [handle, awaiter]: d_->transfers) {
+        curl_multi_remove_handle(d_->multi, handle);
+    }
+    d_->transfers.clear();
+    d_->tasks.clear();
+
+    curl_multi_cleanup(d_->multi);
+}
+
+void EventLoop::Spawn(Task<void>&& task)
+{
+    d_->ready.push_back(task.handle_);
+    d_->tasks.push_back(std::move(task));
+}
+
+void EventLoop::Run()
+{
+    EventLoop* previous = std::exchange(current, this);
+    auto _ = finally([&]() { current = previous; });
+
+    for (;;) {
+        while (!d_->ready.empty()) {
+            auto handle = d_->ready.front();
+            d_->ready.pop_front();
+            handle.resume();
+        }
+
+        if (d_->transfers.empty()) {
+            break;
+        }
+
+        int running;
+        curl_multi_perform(d_->multi, &running);
+        d_->complete();
+
+        if (d_->ready.empty()) {
+            curl_multi_poll(d_->multi, nullptr, 0, POLL_TIMEOUT_MS, nullptr);
+        }
+    }
+
+    std::vector<Task<void>> tasks;
+    tasks.swap(d_->tasks);
+
+    for (Task<void>& task: tasks) {
+        if (!task.handle_.done()) {
+            throw InfluxError("EventLoop stalled: a task awaits something the loop does not drive");
+        }
+    }
+
+    for (Task<void>& task: tasks) {
+        task.handle_.promise().result();
+    }
+}
+
+EventLoop* EventLoop::Current()
+{
+    return current;
+}
+
+EventLoop::TransferAwaiter EventLoop::transfer(void* handle)
+{
+    return TransferAwaiter{*this, handle};
+}
+
+bool EventLoop::TransferAwaiter::await_suspend(std::coroutine_handle<> awaiting)
+{
+    if (curl_multi_add_handle(loop.d_->multi, static_cast<CURL*>(handle)) != CURLM_OK) {
+        result = CURLE_FAILED_INIT;
+        return false;
+    }
+
+    waiting = awaiting;
+    loop.d_->transfers[static_cast<CURL*>(handle)] = this;
+    return true;
+}
+
+} // namespace
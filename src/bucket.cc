@@ -1,14 +1,367 @@
+#include <algorithm>
+#include <condition_variable>
 #include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
 #include <iostream>  // FIXME: remove
-#include <sstream>
+#include <thread>
+#include <vector>
 
 #include <cassert>
+#include <cstdint>
 
 #include <influx/bucket.hh>
 #include <influx/client.hh>
 
+#include "gzip.hh"
+#include "line_protocol.hh"
+#include "mapped_file.hh"
+#include "util.hh"
+
 namespace influx {
 
+namespace {
+    // Below this many points per worker, spawning threads costs more than it saves
+    const std::size_t MIN_POINTS_PER_SERIALIZER = 4096;
+
+    struct SeriesOrderEntry {
+        std::uint64_t series;
+        std::int64_t time;
+        std::size_t index;
+
+        bool operator<(const SeriesOrderEntry& other) const
+        {
+            if (series != other.series) {
+                return series < other.series;
+            } else if (time != other.time) {
+                return time < other.time;
+            }
+            return index < other.index;
+        }
+    };
+
+    // FNV-1a, fed with the measurement name and its (already key-sorted) tags.
+    // Collisions only merge two series in the ordering, never affect correctness.
+    class SeriesHasher {
+    public:
+        void feed(const std::string& str)
+        {
+            for (char c: str) {
+                hash_ = (hash_ ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+            }
+            hash_ = (hash_ ^ 0xff) * 0x100000001b3ull;
+        }
+
+        std::uint64_t value() const { return hash_; }
+
+    private:
+        std::uint64_t hash_ = 0xcbf29ce484222325ull;
+    };
+
+    std::uint64_t SeriesHash(const Measurement& measurement)
+    {
+        SeriesHasher hasher;
+        hasher.feed(measurement.name());
+        for (const Tag& tag: measurement.tags()) {
+            hasher.feed(tag.key);
+            hasher.feed(tag.value);
+        }
+        return hasher.value();
+    }
+
+    std::vector<std::size_t> SeriesOrder(const std::deque<Measurement>& buffer, std::size_t count)
+    {
+        std::vector<SeriesOrderEntry> entries;
+        entries.reserve(count);
+
+        for (std::size_t i = 0; i < count; i++) {
+            entries.push_back({SeriesHash(buffer[i]), buffer[i].timestamp().time_since_epoch().count(), i});
+        }
+
+        std::sort(entries.begin(), entries.end());
+
+        std::vector<std::size_t> order;
+        order.reserve(entries.size());
+        for (const SeriesOrderEntry& entry: entries) {
+            order.push_back(entry.index);
+        }
+        return order;
+    }
+
+    // Serialize buffer[begin, end), through order if it is not empty
+    std::string Serialize(const std::deque<Measurement>& buffer, const std::vector<std::size_t>& order, std::size_t begin, std::size_t end)
+    {
+        std::string out;
+
+        for (std::size_t i = begin; i < end; i++) {
+            lp::Append(out, buffer[order.empty() ? i : order[i]]);
+            out.push_back('\n');
+
+            if (i == begin) {
+                out.reserve(out.size() * (end - begin) * 5 / 4);
+            }
+        }
+
+        return out;
+    }
+
+    // Points taken out of the buffer for one request
+    struct Batch {
+        std::deque<Measurement> points;
+        std::string lines;
+        std::size_t lineCount = 0;
+
+        std::size_t size() const { return points.size() + lineCount; }
+    };
+
+    // Threads of a pipeline serializing parts of large batches. Started on
+    // first use and kept until the pipeline goes, so flushes do not pay for
+    // thread creation.
+    class SerializerPool {
+    public:
+        SerializerPool() = default;
+        SerializerPool(const SerializerPool&) = delete;
+        SerializerPool& operator=(const SerializerPool&) = delete;
+
+        ~SerializerPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            wake_.notify_all();
+
+            for (std::thread& thread: threads_) {
+                thread.join();
+            }
+        }
+
+        // Run task on one of at least size threads
+        std::future<std::string> submit(std::function<std::string()> task, std::size_t size)
+        {
+            std::packaged_task<std::string()> job(std::move(task));
+            std::future<std::string> result = job.get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queue_.push_back(std::move(job));
+                while (threads_.size() < size) {
+                    threads_.emplace_back([this]() { run(); });
+                }
+            }
+            wake_.notify_one();
+            return result;
+        }
+
+    private:
+        void run()
+        {
+            for (;;) {
+                std::packaged_task<std::string()> job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    wake_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+                    if (queue_.empty()) {
+                        return;
+                    }
+                    job = std::move(queue_.front());
+                    queue_.pop_front();
+                }
+                job();
+            }
+        }
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::deque<std::packaged_task<std::string()>> queue_;
+        std::vector<std::thread> threads_;
+        bool stopping_ = false;
+    };
+
+    // Serialize the points of batch. Large batches are split in contiguous
+    // ranges serialized concurrently on pool, to be sent back-to-back as a
+    // single request body. Lines written from PointViews follow, as they are.
+    std::vector<std::string> SerializeBatch(const Batch& batch, FlushOrder flushOrder, std::size_t threads, SerializerPool& pool)
+    {
+        const std::deque<Measurement>& buffer = batch.points;
+        const std::size_t count = buffer.size();
+
+        std::vector<std::size_t> order;
+        if (flushOrder == FlushOrder::Series) {
+            order = SeriesOrder(buffer, count);
+        }
+
+        const std::size_t workers = std::clamp<std::size_t>(count / MIN_POINTS_PER_SERIALIZER, 1, threads);
+        const std::size_t perWorker = (count + workers - 1) / workers;
+
+        // Pool threads read buffer and order until their part is done, even
+        // when this one fails
+        std::vector<std::future<std::string>> pending;
+        auto waitPending = finally([&]() {
+            for (auto& chunk: pending) {
+                if (chunk.valid()) {
+                    chunk.wait();
+                }
+            }
+        });
+
+        for (std::size_t i = 1; i < workers; i++) {
+            const std::size_t begin = std::min(count, i * perWorker);
+            const std::size_t end = std::min(count, (i + 1) * perWorker);
+            pending.push_back(pool.submit([&, begin, end]() { return Serialize(buffer, order, begin, end); }, workers - 1));
+        }
+
+        std::vector<std::string> chunks;
+        chunks.push_back(Serialize(buffer, order, 0, std::min(count, perWorker)));
+        for (auto& chunk: pending) {
+            chunks.push_back(chunk.get());
+        }
+
+        if (!batch.lines.empty()) {
+            chunks.push_back(batch.lines);
+        }
+
+        return chunks;
+    }
+
+    std::size_t DefaultSerializationThreads()
+    {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    bool IsThrottling(int status)
+    {
+        return status == 429 || status == 503;
+    }
+
+    // Additive increase while writes complete under the target latency,
+    // multiplicative decrease when they don't, plus exponential backoff of
+    // automatic flushes while the server is throttling.
+    class BatchController {
+    public:
+        explicit BatchController(const AdaptiveBatching& options)
+            : options_(options)
+        {
+            state_.batchSize = std::clamp(options.initialBatchSize, options.minBatchSize, options.maxBatchSize);
+        }
+
+        std::size_t batchSize() const { return state_.batchSize; }
+        const BatchingState& state() const { return state_; }
+
+        bool paused() const
+        {
+            return std::chrono::steady_clock::now() < resumeAt_;
+        }
+
+        // Whether an automatic flush is due with buffered points waiting
+        bool due(std::size_t buffered)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            if (buffered == 0) {
+                oldest_.reset();
+                return false;
+            }
+            if (!oldest_) {
+                oldest_ = now;
+            }
+
+            if (buffered >= state_.batchSize || (options_.maxDelay.count() > 0 && now - *oldest_ >= options_.maxDelay)) {
+                oldest_.reset();
+                return true;
+            }
+            return false;
+        }
+
+        // The buffer was emptied by a flush
+        void drained() { oldest_.reset(); }
+
+        void accepted(const std::chrono::milliseconds& latency)
+        {
+            state_.lastLatency = latency;
+            state_.backoff = std::chrono::milliseconds(0);
+
+            if (latency <= options_.targetLatency) {
+                state_.batchSize = std::min(state_.batchSize + options_.increase, options_.maxBatchSize);
+            } else {
+                shrink();
+            }
+        }
+
+        void throttled(const std::chrono::milliseconds& latency)
+        {
+            state_.lastLatency = latency;
+            state_.throttledWrites++;
+            shrink();
+
+            if (state_.backoff.count() == 0) {
+                state_.backoff = options_.initialBackoff;
+            } else {
+                state_.backoff = std::min(state_.backoff * 2, options_.maxBackoff);
+            }
+            resumeAt_ = std::chrono::steady_clock::now() + state_.backoff;
+        }
+
+    private:
+        void shrink()
+        {
+            auto decreased = static_cast<std::size_t>(static_cast<double>(state_.batchSize) * options_.decrease);
+            state_.batchSize = std::max(decreased, options_.minBatchSize);
+        }
+
+        AdaptiveBatching options_;
+        BatchingState state_;
+        std::chrono::steady_clock::time_point resumeAt_;
+        std::optional<std::chrono::steady_clock::time_point> oldest_;  // since the last flush
+    };
+
+    // Approximate line protocol size of a point, for buffer accounting
+    std::size_t EstimatedSize(const Measurement& measurement)
+    {
+        // Separators, timestamp and newline
+        std::size_t size = measurement.name().size() + 22;
+
+        for (const Tag& tag: measurement.tags()) {
+            size += tag.key.size() + tag.value.size() + 2;
+        }
+
+        for (const Field& field: measurement.fields()) {
+            size += field.key.size() + 2;
+            if (const auto* value = std::get_if<std::string>(&field.value)) {
+                size += value->size() + 2;
+            } else {
+                size += 20;
+            }
+        }
+
+        return size;
+    }
+
+    // Cut the longest prefix of data ending at a line boundary within size
+    // bytes, or the first line if it is longer than that
+    std::string_view CutBatch(std::string_view& data, std::size_t size)
+    {
+        std::size_t length = data.size();
+
+        if (length > size) {
+            length = data.rfind('\n', size - 1);
+            if (length == std::string_view::npos) {
+                length = data.find('\n', size);
+            }
+            length = length == std::string_view::npos ? data.size() : length + 1;
+        }
+
+        std::string_view batch = data.substr(0, length);
+        data.remove_prefix(length);
+        return batch;
+    }
+
+    std::chrono::milliseconds Since(const std::chrono::steady_clock::time_point& start)
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    }
+}
+
 struct Bucket::Priv {
     // From API
     std::string id;
@@ -16,57 +369,337 @@ struct Bucket::Priv {
     std::string orgId;
 
     // Local data
-    transport::HttpClient client;  
+    transport::HttpClient client;
+    transport::RequestTemplate write;  // prepared once, shared by copies
+    FlushOrder order = FlushOrder::Arrival;
+    std::size_t serializationThreads = DefaultSerializationThreads();
+    SerializerPool serializers;
+
+    // Guards the buffer and its accounting. Requests are made without it, so
+    // producers never wait on the network unless the buffer is full.
+    mutable std::mutex mutex;
+    std::condition_variable drained;
     std::deque<Measurement> buffer;
+    std::string lines;  // PointView writes, already serialized
+    std::size_t lineCount = 0;
+    std::optional<BatchController> batching;
+    BufferLimits limits;
+    std::size_t pendingPoints = 0;  // buffered or in flight
+    std::size_t pendingBytes = 0;
+    std::size_t dropped = 0;
+    std::vector<Measurement> pool;  // flushed, for Acquire to hand out again
+    std::size_t poolCapacity = 0;
+
+    // Serializes use of client
+    mutable std::mutex sendMutex;
+
+    std::size_t buffered() const
+    {
+        return buffer.size() + lineCount;
+    }
+
+    bool full(std::size_t size) const
+    {
+        // A lone point is always accepted, however large
+        if (pendingPoints == 0) {
+            return false;
+        }
+        return (limits.maxPoints && pendingPoints + 1 > limits.maxPoints)
+            || (limits.maxBytes && pendingBytes + size > limits.maxBytes);
+    }
+
+    void release(std::size_t points, std::size_t bytes)
+    {
+        pendingPoints -= points;
+        pendingBytes -= bytes;
+        drained.notify_all();
+    }
+
+    // Evict the oldest buffered point. False if all are in flight.
+    bool dropOldest()
+    {
+        if (!buffer.empty()) {
+            release(1, EstimatedSize(buffer.front()));
+            buffer.pop_front();
+        } else if (lineCount > 0) {
+            const std::size_t length = lines.find('\n') + 1;
+            release(1, length);
+            lines.erase(0, length);
+            lineCount--;
+        } else {
+            return false;
+        }
+
+        dropped++;
+        return true;
+    }
+
+    // Make room for a point of size bytes, applying the overflow policy.
+    // Returns false if the point is to be dropped instead.
+    bool reserve(std::unique_lock<std::mutex>& lock, std::size_t size)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + limits.blockTimeout;
+
+        while (full(size)) {
+            switch (limits.policy) {
+            case OverflowPolicy::Flush:
+                if (buffered() > 0) {
+                    lock.unlock();
+                    flush();
+                    lock.lock();
+                    break;
+                }
+                // Only points in flight are left, wait for them
+                [[fallthrough]];
+            case OverflowPolicy::Block:
+                if (!drained.wait_until(lock, deadline, [&]() { return !full(size); })) {
+                    throw BufferFullError();
+                }
+                break;
+            case OverflowPolicy::DropOldest:
+                if (dropOldest()) {
+                    break;
+                }
+                // Points in flight cannot be dropped anymore
+                [[fallthrough]];
+            case OverflowPolicy::DropNewest:
+                dropped++;
+                return false;
+            }
+        }
+
+        pendingPoints++;
+        pendingBytes += size;
+        return true;
+    }
+
+    void push(Measurement&& measurement)
+    {
+        const std::size_t size = EstimatedSize(measurement);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (reserve(lock, size)) {
+            buffer.push_back(std::move(measurement));
+        }
+    }
+
+    void push(const PointView& point)
+    {
+        // Serialized outside the lock, in storage reused across writes
+        thread_local std::string line;
+        line.clear();
+        lp::Append(line, point);
+        line.push_back('\n');
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (reserve(lock, line.size())) {
+            lines.append(line);
+            lineCount++;
+        }
+    }
+
+    // Take up to count of the oldest buffered points
+    Batch take(std::size_t count)
+    {
+        Batch batch;
+
+        auto end = buffer.begin() + static_cast<std::ptrdiff_t>(std::min(count, buffer.size()));
+        batch.points.assign(std::make_move_iterator(buffer.begin()), std::make_move_iterator(end));
+        buffer.erase(buffer.begin(), end);
+        count -= batch.points.size();
+
+        if (count >= lineCount) {
+            batch.lines.swap(lines);
+            batch.lineCount = std::exchange(lineCount, 0);
+        } else if (count > 0) {
+            std::size_t length = 0;
+            for (std::size_t i = 0; i < count; i++) {
+                length = lines.find('\n', length) + 1;
+            }
+            batch.lines.assign(lines, 0, length);
+            batch.lineCount = count;
+            lines.erase(0, length);
+            lineCount -= count;
+        }
+
+        if (batching && buffered() == 0) {
+            batching->drained();
+        }
+        return batch;
+    }
+
+    // Sent measurements are moved to the pool, while it has room
+    void accepted(Batch& batch, const std::chrono::milliseconds& latency)
+    {
+        std::size_t bytes = batch.lines.size();
+        for (const Measurement& measurement: batch.points) {
+            bytes += EstimatedSize(measurement);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (batching) {
+            batching->accepted(latency);
+        }
+        release(batch.size(), bytes);
+
+        for (auto it = batch.points.begin(); it != batch.points.end() && pool.size() < poolCapacity; ++it) {
+            pool.push_back(std::move(*it));
+        }
+    }
+
+    // Put a failed batch back in front of the buffer
+    void rejected(Batch& batch, const std::chrono::milliseconds& latency, bool throttled)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffer.insert(buffer.begin(), std::make_move_iterator(batch.points.begin()), std::make_move_iterator(batch.points.end()));
+        lines.insert(0, batch.lines);
+        lineCount += batch.lineCount;
+
+        if (batching && throttled) {
+            batching->throttled(latency);
+        }
+    }
+
+    // Post up to count of the oldest buffered points. Returns how many were
+    // sent; on failure they are buffered again.
+    std::size_t send(std::size_t count)
+    {
+        std::lock_guard<std::mutex> sending(sendMutex);
+
+        Batch batch;
+        FlushOrder batchOrder;
+        std::size_t threads;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            batch = take(count);
+            batchOrder = order;
+            threads = serializationThreads;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        try {
+            auto chunks = SerializeBatch(batch, batchOrder, threads, serializers);
+            start = std::chrono::steady_clock::now();
+            client.Post(write, chunks);
+        } catch (InfluxRemoteError& e) {
+            rejected(batch, Since(start), IsThrottling(e.statusCode()));
+            throw;
+        } catch (...) {
+            rejected(batch, Since(start), false);
+            throw;
+        }
+
+        const std::size_t sent = batch.size();
+        accepted(batch, Since(start));
+        return sent;
+    }
+
+    // Send the points buffered so far, in batches if adaptive batching is on
+    void flush()
+    {
+        std::size_t remaining;
+        std::size_t batchSize;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            remaining = buffered();
+            batchSize = batching ? batching->batchSize() : remaining;
+        }
+
+        do {
+            const std::size_t sent = send(std::min(remaining, batchSize));
+            if (sent == 0) {
+                break;
+            }
+            remaining -= std::min(sent, remaining);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (batching) {
+                batchSize = batching->batchSize();
+            }
+        } while (remaining > 0);
+    }
+
+    // Send a batch once enough points are buffered, unless backing off.
+    // Throttled points stay buffered for a later attempt.
+    void autoFlush()
+    {
+        std::size_t count;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!batching || batching->paused() || !batching->due(buffered())) {
+                return;
+            }
+            count = batching->batchSize();
+        }
+
+        try {
+            send(count);
+        } catch (InfluxRemoteError& e) {
+            if (!IsThrottling(e.statusCode())) {
+                throw;
+            }
+        }
+    }
 };
 
 Bucket::Bucket()
-    : d_(new Priv)
 {
 }
 
-Bucket::Bucket(Bucket&& other)
-    : d_(new Priv)
+Bucket::Bucket(Bucket&& other) noexcept
+    : d_(std::move(other.d_))
 {
-    *this = std::move(other);
 }
 
-Bucket& Bucket::operator=(Bucket&& other)
+Bucket& Bucket::operator=(Bucket&& other) noexcept
 {
-    d_.swap(other.d_);
+    d_ = std::move(other.d_);
     return *this;
 }
 
 Bucket::Bucket(const Bucket& other)
-    : d_(new Priv)
+    : d_(other.d_)
 {
-    *this = other;
 }
 
 Bucket& Bucket::operator=(const Bucket& other)
 {
-    d_.reset(new Priv{other.d_->id, other.d_->name, other.d_->orgId, other.d_->client});
+    d_ = other.d_;
     return *this;
 }
 
 Bucket::Bucket(const std::string& id, const std::string& name, const std::string& orgId, transport::HttpClient&& client)
     : d_(new Priv{id, name, orgId, std::move(client)})
 {
+    d_->write = d_->client.Prepare("/api/v2/write?bucket=" + id);
 }
 
+Bucket::Bucket(std::shared_ptr<Priv> d)
+    : d_(std::move(d))
+{
+}
 
 Bucket::~Bucket()
 {
 }
 
+Bucket::Priv& Bucket::priv() const
+{
+    if (!d_) {
+        throw NullBucketError();
+    }
+    return *d_;
+}
+
 Bucket::operator bool() const
 {
-    return !(d_->id.empty() || d_->orgId.empty());
+    return d_ && !(d_->id.empty() || d_->orgId.empty());
 }
 
 bool Bucket::operator==(const Bucket& other) const
 {
-    return d_->id == other.d_->id;
+    return id() == other.id();
 }
 
 bool Bucket::operator!=(const Bucket& other) const
@@ -80,7 +713,28 @@ void Bucket::Write(const Measurement& measurement)
         throw NullBucketError();
     }
 
-    d_->buffer.push_back(measurement);
+    d_->push(Measurement(measurement));
+    d_->autoFlush();
+}
+
+void Bucket::Write(Measurement&& measurement)
+{
+    if (!*this) {
+        throw NullBucketError();
+    }
+
+    d_->push(std::move(measurement));
+    d_->autoFlush();
+}
+
+void Bucket::Write(const PointView& point)
+{
+    if (!*this) {
+        throw NullBucketError();
+    }
+
+    d_->push(point);
+    d_->autoFlush();
 }
 
 void Bucket::Write(const std::vector<Measurement>& measurements)
@@ -100,42 +754,340 @@ void Bucket::Flush()
         throw NullBucketError();
     }
 
-    std::stringstream sbuf;
-    for (const Measurement& measurement: d_->buffer) {
-        sbuf << measurement << std::endl;
+    d_->flush();
+}
+
+ImportStats Bucket::Import(const std::string& path, const ImportOptions& options)
+{
+    if (!*this) {
+        throw NullBucketError();
+    }
+
+    MappedFile file(path);
+    return ImportLines(file.data(), options);
+}
+
+ImportStats Bucket::ImportLines(std::string_view lines, const ImportOptions& options)
+{
+    if (!*this) {
+        throw NullBucketError();
+    }
+
+    if (options.batchBytes == 0) {
+        throw InfluxError("Import batch size must be positive");
+    }
+
+    // Other handles may change the shared client meanwhile: work on a copy
+    const transport::HttpClient base = [&]() {
+        std::lock_guard<std::mutex> sending(d_->sendMutex);
+        return d_->client;
+    }();
+    const transport::RequestTemplate gzipWrite = base.Prepare("/api/v2/write?bucket=" + d_->id, {{"Content-Encoding", "gzip"}});
+
+    // The caller's limits apply to every worker, not just this thread's
+    const RequestOptions* scope = RequestScope::Current();
+    const RequestOptions callerOptions = scope ? *scope : RequestOptions{};
+
+    std::mutex mutex;
+    ImportStats stats;
+    bool failed = false;
+
+    auto next = [&]() -> std::string_view {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (failed) {
+            return {};
+        }
+
+        std::string_view batch = CutBatch(lines, options.batchBytes);
+        stats.bytes += batch.size();
+        stats.requests += !batch.empty();
+        return batch;
+    };
+
+    auto worker = [&](transport::HttpClient client) {
+        RequestScope workerScope(callerOptions);
+
+        try {
+            for (std::string_view batch = next(); !batch.empty(); batch = next()) {
+                if (options.compressionLevel > 0) {
+                    const std::string body = Gzip(batch, options.compressionLevel);
+                    client.Post(gzipWrite, body);
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stats.sentBytes += body.size();
+                } else {
+                    client.Post(d_->write, batch);
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stats.sentBytes += batch.size();
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            failed = true;
+            throw;
+        }
+    };
+
+    // Each connection needs its own client; this thread runs one of them
+    std::vector<std::future<void>> pending;
+    for (std::size_t i = 1; i < std::max<std::size_t>(options.concurrency, 1); i++) {
+        pending.push_back(std::async(std::launch::async, worker, base));
+    }
+
+    std::exception_ptr error;
+    try {
+        worker(base);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    for (auto& result: pending) {
+        try {
+            result.get();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    return stats;
+}
+
+Task<void> Bucket::FlushAsync()
+{
+    if (!*this) {
+        throw NullBucketError();
+    }
+
+    // Keeps the pipeline alive until the request completes, whatever happens
+    // to this handle meanwhile
+    const std::shared_ptr<Priv> d = d_;
+
+    // Requests go through a copy, which shares the connection cache: setters
+    // may change d->client while this awaits, and take sendMutex to do so
+    transport::HttpClient client = [&]() {
+        std::lock_guard<std::mutex> sending(d->sendMutex);
+        return d->client;
+    }();
+
+    // Points written while a request is in flight are left for the next
+    // flush; those buffered now go in batches, as Flush sends them
+    std::size_t remaining;
+    {
+        std::lock_guard<std::mutex> lock(d->mutex);
+        remaining = d->buffered();
     }
 
-    d_->client.Post(
-        "/api/v2/write?bucket=" + d_->id,
-        sbuf.str()
-    );
+    while (remaining > 0) {
+        Batch batch;
+        FlushOrder order;
+        std::size_t threads;
+        {
+            std::lock_guard<std::mutex> lock(d->mutex);
+            batch = d->take(std::min(remaining, d->batching ? d->batching->batchSize() : remaining));
+            order = d->order;
+            threads = d->serializationThreads;
+        }
+
+        if (batch.size() == 0) {
+            break;
+        }
+        remaining -= std::min(batch.size(), remaining);
 
-    d_->buffer.clear();
+        auto start = std::chrono::steady_clock::now();
+
+        try {
+            auto body = SerializeBatch(batch, order, threads, d->serializers);
+            start = std::chrono::steady_clock::now();
+            co_await client.PostAsync(d->write, std::move(body));
+        } catch (InfluxRemoteError& e) {
+            d->rejected(batch, Since(start), IsThrottling(e.statusCode()));
+            throw;
+        } catch (...) {
+            d->rejected(batch, Since(start), false);
+            throw;
+        }
+
+        d->accepted(batch, Since(start));
+    }
+}
+
+void Bucket::SetFlushOrder(FlushOrder order)
+{
+    Priv& d = priv();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    d.order = order;
+}
+
+FlushOrder Bucket::flushOrder() const
+{
+    Priv& d = priv();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    return d.order;
+}
+
+void Bucket::SetSerializationThreads(std::size_t threads)
+{
+    Priv& d = priv();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    d.serializationThreads = std::max<std::size_t>(threads, 1);
+}
+
+std::size_t Bucket::serializationThreads() const
+{
+    Priv& d = priv();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    return d.serializationThreads;
+}
+
+void Bucket::SetRequestOptions(const RequestOptions& options)
+{
+    Priv& d = priv();
+    std::lock_guard<std::mutex> sending(d.sendMutex);
+    d.client.SetDefaultOptions(options);
+}
+
+RequestOptions Bucket::requestOptions() const
+{
+    Priv& d = priv();
+    std::lock_guard<std::mutex> sending(d.sendMutex);
+    return d.client.defaultOptions();
+}
+
+void Bucket::SetWriteTransport(transport::WriteTransport transport)
+{
+    Priv& d = priv();
+    std::lock_guard<std::mutex> sending(d.sendMutex);
+    d.client.SetWriteTransport(transport);
+}
+
+transport::WriteTransport Bucket::writeTransport() const
+{
+    Priv& d = priv();
+    std::lock_guard<std::mutex> sending(d.sendMutex);
+    return d.client.writeTransport();
+}
+
+void Bucket::EnableAdaptiveBatching(const AdaptiveBatching& options)
+{
+    Priv& d = priv();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    d.batching.emplace(options);
+}
+
+void Bucket::DisableAdaptiveBatching()
+{
+    Priv& d = priv();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    d.batching.reset();
+}
+
+std::optional<BatchingState> Bucket::batchingState() const
+{
+    Priv& d = priv();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    if (!d.batching) {
+        return std::nullopt;
+    }
+    return d.batching->state();
+}
+
+void Bucket::SetBufferLimits(const BufferLimits& limits)
+{
+    Priv& d = priv();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    d.limits = limits;
+    d.drained.notify_all();
+}
+
+BufferLimits Bucket::bufferLimits() const
+{
+    Priv& d = priv();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    return d.limits;
+}
+
+void Bucket::SetMeasurementPoolSize(std::size_t size)
+{
+    Priv& d = priv();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    d.poolCapacity = size;
+    if (d.pool.size() > size) {
+        d.pool.erase(d.pool.begin() + static_cast<std::ptrdiff_t>(size), d.pool.end());
+    }
+}
+
+std::size_t Bucket::measurementPoolSize() const
+{
+    Priv& d = priv();
+    std::lock_guard<std::mutex> lock(d.mutex);
+    return d.poolCapacity;
+}
+
+Measurement Bucket::Acquire(std::string_view name, Timestamp timestamp)
+{
+    Priv& d = priv();
+    std::optional<Measurement> measurement;
+    {
+        std::lock_guard<std::mutex> lock(d.mutex);
+        if (!d.pool.empty()) {
+            measurement.emplace(std::move(d.pool.back()));
+            d.pool.pop_back();
+        }
+    }
+
+    if (!measurement) {
+        return Measurement(std::string(name), timestamp);
+    }
+
+    measurement->Reset(name, timestamp);
+    return std::move(*measurement);
 }
 
 std::size_t Bucket::BufferedMeasurementsCount() const
 {
-    return d_->buffer.size();
+    if (!d_) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(d_->mutex);
+    return d_->buffered();
+}
+
+std::size_t Bucket::DroppedMeasurementsCount() const
+{
+    if (!d_) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(d_->mutex);
+    return d_->dropped;
 }
 
 std::string Bucket::id() const
 {
-    return d_->id;
+    return d_ ? d_->id : std::string();
 }
 
 std::string Bucket::name() const
 {
-    return d_->name;
+    return d_ ? d_->name : std::string();
 }
 
 std::string Bucket::orgId() const
 {
-    return d_->orgId;
+    return d_ ? d_->orgId : std::string();
 }
 
 bool Bucket::is_system_bucket() const
 {
-    return d_->name.starts_with("_");
+    return d_ && d_->name.starts_with("_");
 }
 
 } // namespace
@@ -145,3 +1097,15 @@ influx::Bucket& operator<<(influx::Bucket& bucket, const influx::Measurement& me
     bucket.Write(measurement);
     return bucket;
 }
+
+influx::Bucket& operator<<(influx::Bucket& bucket, influx::Measurement&& measurement)
+{
+    bucket.Write(std::move(measurement));
+    return bucket;
+}
+
+influx::Bucket& operator<<(influx::Bucket& bucket, const influx::PointView& point)
+{
+    bucket.Write(point);
+    return bucket;
+}
@@ -0,0 +1,251 @@
+#include <future>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <influx/bucket_range.hh>
+
+namespace influx {
+
+namespace {
+    // Picks id, name and orgID out of each element of the "buckets" array
+    // without building a DOM for the (much larger) rest of the response.
+    class BucketListHandler : public nlohmann::json_sax<nlohmann::json> {
+    public:
+        explicit BucketListHandler(std::vector<BucketInfo>& out)
+            : out_(out)
+        {
+        }
+
+        bool null() override { return value(); }
+        bool boolean(bool) override { return value(); }
+        bool number_integer(number_integer_t) override { return value(); }
+        bool number_unsigned(number_unsigned_t) override { return value(); }
+        bool number_float(number_float_t, const string_t&) override { return value(); }
+        bool binary(binary_t&) override { return value(); }
+
+        bool string(string_t& str) override
+        {
+            if (target_) {
+                *target_ = std::move(str);
+            }
+            return value();
+        }
+
+        bool key(string_t& key) override
+        {
+            if (depth_ == 1) {
+                bucketsKey_ = (key == "buckets");
+            } else if (inBuckets_ && depth_ == 3) {
+                if (key == "id") {
+                    target_ = &out_.back().id;
+                } else if (key == "name") {
+                    target_ = &out_.back().name;
+                } else if (key == "orgID") {
+                    target_ = &out_.back().orgId;
+                }
+            }
+            return true;
+        }
+
+        bool start_object(std::size_t) override
+        {
+            depth_++;
+            if (inBuckets_ && depth_ == 3) {
+                out_.emplace_back();
+            }
+            return value();
+        }
+
+        bool end_object() override
+        {
+            depth_--;
+            return true;
+        }
+
+        bool start_array(std::size_t) override
+        {
+            depth_++;
+            if (depth_ == 2 && bucketsKey_) {
+                inBuckets_ = true;
+            }
+            return value();
+        }
+
+        bool end_array() override
+        {
+            if (depth_ == 2) {
+                inBuckets_ = false;
+            }
+            depth_--;
+            return true;
+        }
+
+        bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override
+        {
+            return false;
+        }
+
+    private:
+        bool value()
+        {
+            target_ = nullptr;
+            if (depth_ == 1) {
+                bucketsKey_ = false;
+            }
+            return true;
+        }
+
+        std::vector<BucketInfo>& out_;
+        std::size_t depth_ = 0;
+        bool bucketsKey_ = false;
+        bool inBuckets_ = false;
+        std::string* target_ = nullptr;
+    };
+
+    std::vector<BucketInfo> FetchPage(transport::HttpClient& client, std::size_t limit, std::size_t offset)
+    {
+        auto response = client.Get(
+            "/api/v2/buckets?limit=" + std::to_string(limit) + "&offset=" + std::to_string(offset)
+        );
+
+        std::vector<BucketInfo> page;
+        BucketListHandler handler(page);
+        if (!nlohmann::json::sax_parse(response.body, &handler)) {
+            throw InfluxError("Invalid bucket list response");
+        }
+
+        return page;
+    }
+}
+
+bool BucketInfo::is_system_bucket() const
+{
+    return name.starts_with("_");
+}
+
+struct BucketRange::Priv {
+    transport::HttpClient client;
+    const std::size_t pageSize;
+
+    std::vector<BucketInfo> page;
+    std::size_t index = 0;
+    std::size_t offset = 0;
+    bool started = false;
+    bool last = false;
+
+    // Declared last: must be joined before the client it uses is destroyed
+    std::future<std::vector<BucketInfo>> next;
+
+    void prefetch()
+    {
+        if (last) {
+            return;
+        }
+
+        // Under the limits of the thread asking for the page
+        const RequestOptions* scope = RequestScope::Current();
+        next = std::async(std::launch::async, [this, offset = offset, options = scope ? *scope : RequestOptions{}]() {
+            RequestScope pageScope(options);
+            return FetchPage(client, pageSize, offset);
+        });
+    }
+
+    // Move to the next page, skipping empty ones; false once exhausted
+    bool advance()
+    {
+        while (!last) {
+            try {
+                page = next.get();
+            } catch (...) {
+                // No page to wait for any more: the range ends here
+                last = true;
+                page.clear();
+                index = 0;
+                throw;
+            }
+            index = 0;
+            last = page.size() < pageSize;
+            offset += page.size();
+            prefetch();
+
+            if (!page.empty()) {
+                return true;
+            }
+        }
+
+        page.clear();
+        index = 0;
+        return false;
+    }
+};
+
+BucketRange::BucketRange(transport::HttpClient&& client, std::size_t pageSize)
+    : d_(new Priv{std::move(client), pageSize})
+{
+    if (pageSize < 1 || pageSize > 100) {
+        throw InfluxError("Limit must be within range [1, 100]");
+    }
+
+    d_->prefetch();
+}
+
+BucketRange::BucketRange(BucketRange&& other) = default;
+BucketRange& BucketRange::operator=(BucketRange&& other) = default;
+
+BucketRange::~BucketRange()
+{
+}
+
+BucketRange::iterator BucketRange::begin()
+{
+    if (!d_->started) {
+        d_->started = true;
+        d_->advance();
+    }
+
+    return iterator(this);
+}
+
+std::default_sentinel_t BucketRange::end() const
+{
+    return std::default_sentinel;
+}
+
+BucketRange::iterator::iterator(BucketRange* range)
+    : range_(range)
+{
+}
+
+BucketRange::iterator::reference BucketRange::iterator::operator*() const
+{
+    return range_->d_->page[range_->d_->index];
+}
+
+BucketRange::iterator::pointer BucketRange::iterator::operator->() const
+{
+    return &**this;
+}
+
+BucketRange::iterator& BucketRange::iterator::operator++()
+{
+    Priv& d = *range_->d_;
+
+    if (++d.index >= d.page.size()) {
+        d.advance();
+    }
+
+    return *this;
+}
+
+void BucketRange::iterator::operator++(int)
+{
+    ++*this;
+}
+
+bool BucketRange::iterator::operator==(std::default_sentinel_t) const
+{
+    return range_ == nullptr || range_->d_->index >= range_->d_->page.size();
+}
+
+} // namespace
@@ -1,6 +1,9 @@
 #include <algorithm>
+#include <array>
+#include <mutex>
 
 #include <cassert>
+#include <cstdio>
 #include <cstring>
 
 #define NOMINMAX
@@ -12,70 +15,409 @@
 
 #include <influx/client.hh>
 
+#include "http1.hh"
 #include "util.hh"
 
 namespace influx::transport {
 
 namespace {
+    const std::string_view UNIX_SCHEME = "unix://";
+
+    // Largest body buffer reserved up front from a Content-Length header
+    const curl_off_t MAX_BODY_RESERVE = 64 << 20;
+
     struct ReadCallbackData {
-        const std::string& body;
+        const std::vector<std::string_view>& chunks;
+        std::size_t chunk = 0;
         std::size_t cursor = 0;
+
+        curl_off_t length() const
+        {
+            curl_off_t total = 0;
+            for (const auto& chunk: chunks) {
+                total += static_cast<curl_off_t>(chunk.length());
+            }
+            return total;
+        }
     };
 
     struct WriteCallbackData {
         std::string body;
+
+        CURL* handle = nullptr;
+
+        // Successful response bodies go there instead, when set
+        const BodySink* sink = nullptr;
+        std::exception_ptr error;
+
+        bool streaming() const
+        {
+            long status = 0;
+            return sink && curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status) == CURLE_OK && status / 100 == 2;
+        }
     };
 
     std::size_t ReadCallback(char *buffer, std::size_t size, std::size_t nitems, void *userdata)
     {
         ReadCallbackData& data = *(static_cast<ReadCallbackData*>(userdata));
-        std::size_t readSize = std::min(data.body.length() - data.cursor, size * nitems);
+        std::size_t readSize = 0;
 
-        if (readSize == 0) {
-            return 0;
+        while (readSize < size * nitems && data.chunk < data.chunks.size()) {
+            const std::string_view& chunk = data.chunks[data.chunk];
+            std::size_t n = std::min(chunk.length() - data.cursor, size * nitems - readSize);
+
+            memcpy(static_cast<void*>(buffer + readSize), chunk.data() + data.cursor, n);
+            readSize += n;
+            data.cursor += n;
+
+            if (data.cursor == chunk.length()) {
+                data.chunk++;
+                data.cursor = 0;
+            }
         }
 
-        memcpy(static_cast<void*>(buffer), data.body.c_str() + data.cursor, readSize);
-        data.cursor += readSize;
         return readSize;
     }
 
+    // libcurl rewinds the body to resend it, e.g. over a fresh connection when
+    // a reused one turns out closed
+    int SeekCallback(void* userdata, curl_off_t offset, int origin)
+    {
+        ReadCallbackData& data = *(static_cast<ReadCallbackData*>(userdata));
+        if (origin != SEEK_SET || offset < 0) {
+            return CURL_SEEKFUNC_CANTSEEK;
+        }
+
+        auto remaining = static_cast<std::size_t>(offset);
+        data.chunk = 0;
+        while (data.chunk < data.chunks.size() && remaining >= data.chunks[data.chunk].length()) {
+            remaining -= data.chunks[data.chunk].length();
+            data.chunk++;
+        }
+        data.cursor = remaining;
+
+        return data.chunk < data.chunks.size() || remaining == 0 ? CURL_SEEKFUNC_OK : CURL_SEEKFUNC_FAIL;
+    }
+
+    int ProgressCallback(void* userdata, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+    {
+        const auto* token = static_cast<const CancellationToken*>(userdata);
+        return token->cancelled() ? 1 : 0;
+    }
+
+    /* State shared by a client and its copies, which may be used from
+     * different threads: DNS and TLS session caches, and idle handles along
+     * with the connections they keep open. libcurl cannot share a connection
+     * cache between concurrent threads, so pooling handles stands in for it. */
+    class SharedCache {
+    public:
+        SharedCache()
+            : share_(curl_share_init())
+        {
+            curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, Lock);
+            curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, Unlock);
+            curl_share_setopt(share_, CURLSHOPT_USERDATA, (void*)this);
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        }
+
+        SharedCache(const SharedCache&) = delete;
+        SharedCache& operator=(const SharedCache&) = delete;
+
+        ~SharedCache()
+        {
+            for (CURL* handle: idle_) {
+                curl_easy_cleanup(handle);
+            }
+            curl_share_cleanup(share_);
+        }
+
+        CURLSH* share() const { return share_; }
+
+        /* An idle handle, most recently used first, or a new one */
+        CURL* acquire()
+        {
+            {
+                std::lock_guard<std::mutex> lock(idleMutex_);
+                if (!idle_.empty()) {
+                    CURL* handle = idle_.back();
+                    idle_.pop_back();
+                    return handle;
+                }
+            }
+            return curl_easy_init();
+        }
+
+        void release(CURL* handle)
+        {
+            {
+                std::lock_guard<std::mutex> lock(idleMutex_);
+                if (idle_.size() < MAX_IDLE_HANDLES) {
+                    idle_.push_back(handle);
+                    return;
+                }
+            }
+            curl_easy_cleanup(handle);
+        }
+
+    private:
+        static constexpr std::size_t MAX_IDLE_HANDLES = 16;
+
+        static void Lock(CURL*, curl_lock_data data, curl_lock_access, void* userdata)
+        {
+            static_cast<SharedCache*>(userdata)->locks_[data].lock();
+        }
+
+        static void Unlock(CURL*, curl_lock_data data, void* userdata)
+        {
+            static_cast<SharedCache*>(userdata)->locks_[data].unlock();
+        }
+
+        CURLSH* share_;
+        std::array<std::mutex, CURL_LOCK_DATA_LAST> locks_;
+
+        std::mutex idleMutex_;
+        std::vector<CURL*> idle_;
+    };
+
+    /* Connection of the native transport, which copies of a client do not
+     * share: a copy starts without one */
+    struct NativeConnection {
+        std::unique_ptr<Http1Connection> connection;
+
+        NativeConnection() = default;
+        NativeConnection(const NativeConnection&) {}
+        NativeConnection& operator=(const NativeConnection&) { connection.reset(); return *this; }
+    };
+
+    long CurlHttpVersion(HttpVersion version)
+    {
+        switch (version) {
+            case HttpVersion::Http1_1:
+                return CURL_HTTP_VERSION_1_1;
+            case HttpVersion::Http2:
+                return CURL_HTTP_VERSION_2_0;
+            case HttpVersion::Http2PriorKnowledge:
+                return CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE;
+            default:
+                return CURL_HTTP_VERSION_NONE;
+        }
+    }
+
     std::size_t WriteCallback(const char *ptr, std::size_t size, std::size_t nmemb, void *userdata)
     {
         WriteCallbackData& data = *(static_cast<WriteCallbackData*>(userdata));
-        std::string str(ptr, size * nmemb);
-        data.body += str;
-        return str.length();
+
+        // Exceptions must not unwind through libcurl: abort, rethrow later
+        try {
+            if (data.streaming()) {
+                (*data.sink)(std::string_view(ptr, size * nmemb));
+                return size * nmemb;
+            }
+
+            // Size the body once from Content-Length rather than growing it,
+            // within reason: the header is the server's word
+            if (data.body.empty()) {
+                curl_off_t length = -1;
+                if (curl_easy_getinfo(data.handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length) == CURLE_OK && length > 0) {
+                    data.body.reserve(static_cast<std::size_t>(std::min<curl_off_t>(length, MAX_BODY_RESERVE)));
+                }
+            }
+
+            data.body.append(ptr, size * nmemb);
+        } catch (...) {
+            data.error = std::current_exception();
+            return 0;
+        }
+        return size * nmemb;
     }
 }
 
-struct HttpClient::Priv {
-    const std::string host, org, token;
-    CURL* handle = curl_easy_init();
+struct RequestTemplate::Priv {
+    const std::string url;
+    struct curl_slist* const headers;
 
-    std::string makeUrl(const std::string& endpoint)
+    // Request line and headers of a POST over the native transport, for
+    // http:// URLs only
+    const std::string head;
+
+    Priv(std::string url, struct curl_slist* headers, std::string head)
+        : url(std::move(url))
+        , headers(headers)
+        , head(std::move(head))
     {
-        std::string out;
+    }
 
-        if (endpoint.find("?") == std::string::npos) {
-            out = "?orgID=";
-        } else {
-            out = "&orgID=";
+    Priv(const Priv&) = delete;
+    Priv& operator=(const Priv&) = delete;
+
+    ~Priv() { curl_slist_free_all(headers); }
+};
+
+RequestTemplate::RequestTemplate()
+{
+}
+
+RequestTemplate::operator bool() const
+{
+    return d_ != nullptr;
+}
+
+struct HttpClient::Priv {
+    // host is the URL prefix, set to localhost when connecting to socketPath
+    const std::string host, org, token, socketPath;
+    const std::string authorization = "Authorization: Bearer " + token;
+    RequestOptions defaults = {};
+    bool compression = true;
+    HttpVersion version = HttpVersion::Auto;
+
+    std::shared_ptr<SharedCache> cache = std::make_shared<SharedCache>();
+
+    WriteTransport transport = WriteTransport::Curl;
+    NativeConnection native;
+
+    /* Client defaults, overridden by the limits the current scope sets */
+    RequestOptions options() const
+    {
+        const RequestOptions* scope = RequestScope::Current();
+        if (!scope) {
+            return defaults;
         }
 
-        return host + endpoint + out + org;
+        return {
+            scope->connectTimeout.count() ? scope->connectTimeout : defaults.connectTimeout,
+            scope->timeout.count() ? scope->timeout : defaults.timeout,
+            scope->lowSpeedLimit ? scope->lowSpeedLimit : defaults.lowSpeedLimit,
+            scope->lowSpeedTime.count() ? scope->lowSpeedTime : defaults.lowSpeedTime,
+            scope->cancellation ? scope->cancellation : defaults.cancellation
+        };
+    }
+
+    std::string makeUrl(const std::string& endpoint) const
+    {
+        std::string out;
+        out.reserve(host.size() + endpoint.size() + org.size() + 7);
+
+        out.append(host).append(endpoint);
+        out.append(endpoint.find("?") == std::string::npos ? "?orgID=" : "&orgID=");
+        out.append(org);
+        return out;
     }
 
-    struct curl_slist* makeHeaders(const std::unordered_map<std::string, std::string>& headers)
+    std::vector<std::string> makeHeaders(const std::unordered_map<std::string, std::string>& headers) const
     {
-        struct curl_slist* curlHeaders = curl_slist_append(nullptr, ("Authorization: Bearer " + token).c_str());
+        std::vector<std::string> lines{authorization};
+        lines.reserve(headers.size() + 1);
 
         std::for_each(headers.begin(), headers.end(), [&](const auto& kvp) {
-            std::string formatted = kvp.first + ": " + kvp.second;
-            curlHeaders = curl_slist_append(curlHeaders, formatted.c_str());
+            lines.push_back(kvp.first + ": " + kvp.second);
         });
 
-        return curlHeaders;
+        return lines;
+    }
+
+    bool plaintext() const
+    {
+        return host.starts_with("http://");
+    }
+
+    HttpResponse postNative(const RequestTemplate::Priv& request, const std::vector<std::string_view>& body)
+    {
+        if (!native.connection) {
+            auto [address, port] = Http1Authority(host);
+            native.connection = std::make_unique<Http1Connection>(std::move(address), std::move(port), socketPath);
+        }
+        return native.connection->post(request.head, body, options());
+    }
+
+    void prepare(
+        CURL* handle,
+        Verb verb,
+        const RequestTemplate::Priv& request,
+        ReadCallbackData& source,
+        WriteCallbackData& target,
+        const RequestOptions& options
+    )
+    {
+        curl_easy_setopt(handle, CURLOPT_URL, request.url.c_str());
+
+        switch (verb) {
+            case Verb::GET:
+                break;
+            case Verb::POST:
+                curl_easy_setopt(handle, CURLOPT_POST, 1);
+                curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE_LARGE, source.length());
+                break;
+            case Verb::DELETE:
+                curl_easy_setopt(handle, CURLOPT_CUSTOMREQUEST, "DELETE");
+                curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE_LARGE, source.length());
+                break;
+            default:
+                assert(false);
+                break;
+        }
+
+        curl_easy_setopt(handle, CURLOPT_HTTPHEADER, request.headers);
+        curl_easy_setopt(handle, CURLOPT_READFUNCTION, ReadCallback);
+        curl_easy_setopt(handle, CURLOPT_READDATA, (void*)&source);
+        curl_easy_setopt(handle, CURLOPT_SEEKFUNCTION, SeekCallback);
+        curl_easy_setopt(handle, CURLOPT_SEEKDATA, (void*)&source);
+        curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(handle, CURLOPT_WRITEDATA, (void*)&target);
+
+        if (compression) {
+            curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
+        }
+
+        curl_easy_setopt(handle, CURLOPT_SHARE, cache->share());
+
+        if (!socketPath.empty()) {
+            curl_easy_setopt(handle, CURLOPT_UNIX_SOCKET_PATH, socketPath.c_str());
+        }
+
+        curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CurlHttpVersion(version));
+        if (version == HttpVersion::Http2 || version == HttpVersion::Http2PriorKnowledge) {
+            // Wait for a stream on a connection being set up, not a new one
+            curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+        }
+
+        curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(options.connectTimeout.count()));
+        curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, static_cast<long>(options.timeout.count()));
+        curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, static_cast<long>(options.lowSpeedLimit));
+        curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, static_cast<long>(options.lowSpeedTime.count()));
+
+        if (options.cancellation) {
+            curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 0L);
+            curl_easy_setopt(handle, CURLOPT_XFERINFOFUNCTION, ProgressCallback);
+            curl_easy_setopt(handle, CURLOPT_XFERINFODATA, (void*)&*options.cancellation);
+        }
+    }
+
+    HttpResponse response(CURL* handle, CURLcode code, WriteCallbackData& target)
+    {
+        if (target.error) {
+            std::rethrow_exception(target.error);
+        }
+
+        switch (code) {
+            case CURLE_OK:
+                break;
+            case CURLE_OPERATION_TIMEDOUT:
+                throw TimeoutError();
+            case CURLE_ABORTED_BY_CALLBACK:
+                throw CancelledError();
+            default:
+                throw InfluxError(curl_easy_strerror(code));
+        }
+
+        long status;
+        curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status);
+
+        if (status / 100 > 2) {
+            throw InfluxRemoteError(status, std::move(target.body));
+        } else {
+            return {static_cast<int>(status), std::move(target.body)};
+        }
     }
 };
 
@@ -85,24 +427,86 @@ HttpClient::HttpClient()
 }
 
 HttpClient::HttpClient(HttpClient&& other)
-    : d_(new Priv)
+    : d_(std::move(other.d_))
 {
-    d_.swap(other.d_);
 }
 
 HttpClient::HttpClient(const HttpClient& other)
-    : d_(new Priv{other.d_->host, other.d_->org, other.d_->token})
+    : d_(other.d_ ? new Priv(*other.d_) : nullptr)
 {
 }
 
 HttpClient::HttpClient(const std::string& host, const std::string& org, const std::string& token)
-    : d_(new Priv{host, org, token})
+    : d_(host.starts_with(UNIX_SCHEME)
+        ? new Priv{"http://localhost", org, token, host.substr(UNIX_SCHEME.size())}
+        : new Priv{host, org, token})
 {
 }
 
 HttpClient::~HttpClient()
 {
-    curl_easy_cleanup(d_->handle);
+}
+
+void HttpClient::SetDefaultOptions(const RequestOptions& options)
+{
+    d_->defaults = options;
+}
+
+const RequestOptions& HttpClient::defaultOptions() const
+{
+    return d_->defaults;
+}
+
+void HttpClient::SetResponseCompression(bool enabled)
+{
+    d_->compression = enabled;
+}
+
+bool HttpClient::responseCompression() const
+{
+    return d_->compression;
+}
+
+void HttpClient::SetHttpVersion(HttpVersion version)
+{
+    d_->version = version;
+}
+
+HttpVersion HttpClient::httpVersion() const
+{
+    return d_->version;
+}
+
+void HttpClient::SetWriteTransport(WriteTransport transport)
+{
+    if (transport == WriteTransport::Native && !d_->plaintext()) {
+        throw InfluxError("Native transport only supports http:// and unix:// hosts");
+    }
+    d_->transport = transport;
+}
+
+WriteTransport HttpClient::writeTransport() const
+{
+    return d_->transport;
+}
+
+RequestTemplate HttpClient::Prepare(
+    const std::string& endpoint,
+    const std::unordered_map<std::string, std::string>& headers
+) const
+{
+    std::string url = d_->makeUrl(endpoint);
+    const std::vector<std::string> lines = d_->makeHeaders(headers);
+
+    struct curl_slist* curlHeaders = nullptr;
+    for (const auto& line: lines) {
+        curlHeaders = curl_slist_append(curlHeaders, line.c_str());
+    }
+    std::string head = d_->plaintext() ? Http1Head(url, lines) : std::string();
+
+    RequestTemplate request;
+    request.d_ = std::make_shared<const RequestTemplate::Priv>(std::move(url), curlHeaders, std::move(head));
+    return request;
 }
 
 HttpResponse HttpClient::Get(
@@ -110,77 +514,144 @@ HttpResponse HttpClient::Get(
     const std::unordered_map<std::string, std::string>& headers
 )
 {
-    return Perform(Verb::GET, endpoint, std::string(), headers);
+    return Perform(Verb::GET, Prepare(endpoint, headers), {});
+}
+
+HttpResponse HttpClient::Post(
+    const std::string& endpoint,
+    std::string_view body,
+    const std::unordered_map<std::string, std::string>& headers
+)
+{
+    return Perform(Verb::POST, Prepare(endpoint, headers), {body});
 }
 
 HttpResponse HttpClient::Post(
     const std::string& endpoint,
-    const std::string& body,
+    const std::vector<std::string>& chunks,
     const std::unordered_map<std::string, std::string>& headers
 )
 {
-    return Perform(Verb::POST, endpoint, body, headers);
+    return Perform(Verb::POST, Prepare(endpoint, headers), {chunks.begin(), chunks.end()});
+}
+
+int HttpClient::Post(
+    const std::string& endpoint,
+    std::string_view body,
+    const BodySink& sink,
+    const std::unordered_map<std::string, std::string>& headers
+)
+{
+    return Perform(Verb::POST, Prepare(endpoint, headers), {body}, &sink).status;
+}
+
+HttpResponse HttpClient::Post(const RequestTemplate& request, std::string_view body)
+{
+    return Perform(Verb::POST, request, {body});
+}
+
+HttpResponse HttpClient::Post(const RequestTemplate& request, const std::vector<std::string>& chunks)
+{
+    return Perform(Verb::POST, request, {chunks.begin(), chunks.end()});
+}
+
+int HttpClient::Post(const RequestTemplate& request, std::string_view body, const BodySink& sink)
+{
+    return Perform(Verb::POST, request, {body}, &sink).status;
 }
 
 HttpResponse HttpClient::Delete(
     const std::string& endpoint,
-    const std::string& body,
+    std::string_view body,
     const std::unordered_map<std::string, std::string>& headers
 )
 {
-    return Perform(Verb::DELETE, endpoint, body, headers);
+    return Perform(Verb::DELETE, Prepare(endpoint, headers), {body});
 }
 
 HttpResponse HttpClient::Perform(
     Verb verb,
-    const std::string& endpoint,
-    const std::string& body,
-    const std::unordered_map<std::string, std::string>& headers
+    const RequestTemplate& request,
+    const std::vector<std::string_view>& body,
+    const BodySink* sink
 )
 {
+    if (!request) {
+        throw InfluxError("Cannot send an empty request template");
+    }
+
+    if (verb == Verb::POST && !sink && d_->transport == WriteTransport::Native && !request.d_->head.empty()) {
+        return d_->postNative(*request.d_, body);
+    }
+
+    // Handles return to the pool with their connections still open
+    CURL* handle = d_->cache->acquire();
+    auto handleGuard = finally([&]() { d_->cache->release(handle); });
+
     ReadCallbackData source{body};
-    WriteCallbackData target;
-
-    curl_easy_reset(d_->handle);
-    curl_easy_setopt(d_->handle, CURLOPT_URL, d_->makeUrl(endpoint).c_str());
-
-    switch (verb) {
-        case Verb::GET:
-            break;
-        case Verb::POST:
-            curl_easy_setopt(d_->handle, CURLOPT_POST, 1);
-            curl_easy_setopt(d_->handle, CURLOPT_POSTFIELDSIZE, source.body.length());
-            break;
-        case Verb::DELETE:
-            curl_easy_setopt(d_->handle, CURLOPT_CUSTOMREQUEST, "DELETE");
-            curl_easy_setopt(d_->handle, CURLOPT_POSTFIELDSIZE, source.body.length());
-            break;
-        default:
-            assert(false);
-            break;
-    }
-
-    struct curl_slist* curlHeaders = d_->makeHeaders(headers);
-    auto _ = finally([&]() { curl_slist_free_all(curlHeaders); });
-
-    curl_easy_setopt(d_->handle, CURLOPT_HTTPHEADER, curlHeaders);
-    curl_easy_setopt(d_->handle, CURLOPT_READFUNCTION, ReadCallback);
-    curl_easy_setopt(d_->handle, CURLOPT_READDATA, (void*)&source);
-    curl_easy_setopt(d_->handle, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(d_->handle, CURLOPT_WRITEDATA, (void*)&target);
-    
-    if (curl_easy_perform(d_->handle) != CURLE_OK) {
-        throw InfluxError();
-    }
-
-    int status;
-    curl_easy_getinfo(d_->handle, CURLINFO_RESPONSE_CODE, &status);
-
-    if (status / 100 > 2) {
-        throw InfluxRemoteError(status, std::move(target.body));
-    } else {
-        return {status, std::move(target.body)};
+    WriteCallbackData target{{}, handle, sink};
+
+    const RequestOptions options = d_->options();
+
+    curl_easy_reset(handle);
+    d_->prepare(handle, verb, *request.d_, source, target, options);
+
+    return d_->response(handle, curl_easy_perform(handle), target);
+}
+
+Task<HttpResponse> HttpClient::GetAsync(
+    std::string endpoint,
+    std::unordered_map<std::string, std::string> headers
+)
+{
+    co_return co_await PerformAsync(Verb::GET, Prepare(endpoint, headers), {});
+}
+
+Task<HttpResponse> HttpClient::PostAsync(
+    std::string endpoint,
+    std::vector<std::string> chunks,
+    std::unordered_map<std::string, std::string> headers
+)
+{
+    co_return co_await PerformAsync(Verb::POST, Prepare(endpoint, headers), std::move(chunks));
+}
+
+Task<HttpResponse> HttpClient::PostAsync(
+    RequestTemplate request,
+    std::vector<std::string> chunks
+)
+{
+    co_return co_await PerformAsync(Verb::POST, std::move(request), std::move(chunks));
+}
+
+Task<HttpResponse> HttpClient::PerformAsync(
+    Verb verb,
+    RequestTemplate request,
+    std::vector<std::string> body
+)
+{
+    EventLoop* loop = EventLoop::Current();
+    if (!loop) {
+        throw InfluxError("Asynchronous requests must be awaited from a running EventLoop");
     }
+    if (!request) {
+        throw InfluxError("Cannot send an empty request template");
+    }
+
+    // Each transfer gets its own handle so requests from one client can overlap
+    CURL* handle = curl_easy_init();
+    auto handleGuard = finally([&]() { curl_easy_cleanup(handle); });
+
+    const std::vector<std::string_view> chunks(body.begin(), body.end());
+    ReadCallbackData source{chunks};
+    WriteCallbackData target{{}, handle};
+
+    // Captured before suspending: the scope belongs to the awaiting thread
+    const RequestOptions options = d_->options();
+    d_->prepare(handle, verb, *request.d_, source, target, options);
+
+    auto code = static_cast<CURLcode>(co_await loop->transfer(handle));
+    co_return d_->response(handle, code, target);
 }
 
 } // namespace
@@ -0,0 +1,116 @@
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <time.h>
+
+#include <influx/clock.hh>
+
+namespace influx {
+
+namespace {
+    const std::chrono::milliseconds TICK(1);
+
+    std::atomic<TimestampSource> source = TimestampSource::System;
+    std::atomic<Clock::rep> cached;
+
+    Timestamp CoarseNow()
+    {
+#if defined(CLOCK_REALTIME_COARSE)
+        timespec ts;
+        if (clock_gettime(CLOCK_REALTIME_COARSE, &ts) == 0) {
+            return Timestamp(std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+        }
+#endif
+        return Clock::now();
+    }
+
+    // Refreshes cached every TICK while started
+    class Ticker {
+    public:
+        ~Ticker()
+        {
+            stop();
+        }
+
+        void start()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cached = Clock::now().time_since_epoch().count();
+
+            if (!running_) {
+                running_ = true;
+                thread_ = std::thread(&Ticker::run, this);
+            }
+        }
+
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                running_ = false;
+            }
+            wake_.notify_all();
+
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+        }
+
+    private:
+        void run()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!wake_.wait_for(lock, TICK, [this]() { return !running_; })) {
+                cached.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+            }
+        }
+
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        bool running_ = false;
+        std::thread thread_;
+    };
+
+    Ticker& ticker()
+    {
+        static Ticker ticker;
+        return ticker;
+    }
+}
+
+void SetTimestampSource(TimestampSource next)
+{
+    // Starting and stopping the ticker, join included, must not interleave
+    static std::mutex lifecycle;
+    std::lock_guard<std::mutex> lock(lifecycle);
+
+    // The cache must be fresh before anyone reads from it
+    if (next == TimestampSource::Cached) {
+        ticker().start();
+    }
+
+    if (source.exchange(next) == TimestampSource::Cached && next != TimestampSource::Cached) {
+        ticker().stop();
+    }
+}
+
+TimestampSource timestampSource()
+{
+    return source;
+}
+
+Timestamp Now()
+{
+    switch (source.load(std::memory_order_relaxed)) {
+    case TimestampSource::Coarse:
+        return CoarseNow();
+    case TimestampSource::Cached:
+        return Timestamp(Clock::duration(cached.load(std::memory_order_relaxed)));
+    default:
+        return Clock::now();
+    }
+}
+
+} // namespace
@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <string_view>
+
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <influx/datagram_sink.hh>
+
+#include "line_protocol.hh"
+#include "util.hh"
+
+namespace influx {
+
+namespace {
+    const std::string_view UDP_SCHEME = "udp://";
+    const std::string_view UNIXGRAM_SCHEME = "unixgram://";
+
+#if !defined(_WIN32)
+    int ConnectUdp(std::string_view address)
+    {
+        // host:port, with IPv6 hosts in brackets
+        const std::size_t colon = address.rfind(':');
+        if (colon == std::string_view::npos || colon + 1 == address.size()) {
+            throw InfluxError("Datagram address lacks a port");
+        }
+
+        std::string host(address.substr(0, colon));
+        const std::string port(address.substr(colon + 1));
+        if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+            host = host.substr(1, host.size() - 2);
+        }
+
+        struct addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_DGRAM;
+
+        struct addrinfo* results = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &results) != 0) {
+            throw InfluxError("Cannot resolve datagram address");
+        }
+        auto _ = finally([&]() { freeaddrinfo(results); });
+
+        for (struct addrinfo* result = results; result; result = result->ai_next) {
+            const int fd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+            if (fd < 0) {
+                continue;
+            }
+            if (connect(fd, result->ai_addr, result->ai_addrlen) == 0) {
+                return fd;
+            }
+            close(fd);
+        }
+        throw InfluxError("Cannot connect datagram socket");
+    }
+
+    int ConnectUnix(std::string_view path)
+    {
+        struct sockaddr_un addr = {};
+        if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+            throw InfluxError("Invalid Unix socket path");
+        }
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.data(), path.size());
+
+        const int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        if (fd < 0) {
+            throw InfluxError("Cannot create datagram socket");
+        }
+        if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            throw InfluxError("Cannot connect datagram socket");
+        }
+        return fd;
+    }
+#endif
+}
+
+struct DatagramSink::Priv {
+    int fd = -1;
+    DatagramOptions options;
+    DatagramStats stats;
+
+    // Buffered lines, cut into datagrams ending at each offset of ends and,
+    // for the last one, at the end of data
+    std::string data;
+    std::vector<std::size_t> ends;
+    std::size_t datagramStart = 0;
+
+    ~Priv()
+    {
+#if !defined(_WIN32)
+        if (fd >= 0) {
+            close(fd);
+        }
+#endif
+    }
+
+    template <typename Point>
+    void push(const Point& point)
+    {
+        const std::size_t begin = data.size();
+        try {
+            lp::Append(data, point);
+        } catch (...) {
+            data.resize(begin);
+            throw;
+        }
+        data += '\n';
+        stats.points++;
+
+        if (data.size() - datagramStart > options.maxDatagramSize && begin > datagramStart) {
+            ends.push_back(begin);
+            datagramStart = begin;
+        }
+
+        if (ends.size() >= options.batchDatagrams) {
+            send(ends.size());
+        }
+    }
+
+    /* Send the first count datagrams, keeping the others buffered */
+    void send(std::size_t count)
+    {
+#if !defined(_WIN32)
+        std::size_t begin = 0;
+        std::size_t next = 0;
+
+        auto end = [&](std::size_t i) {
+            return i < ends.size() ? ends[i] : data.size();
+        };
+
+#if defined(__linux__)
+        std::vector<struct iovec> iovecs(std::min(count, options.batchDatagrams));
+        std::vector<struct mmsghdr> messages(iovecs.size());
+
+        while (next < count) {
+            const std::size_t batch = std::min(count - next, iovecs.size());
+            for (std::size_t i = 0; i < batch; i++) {
+                iovecs[i].iov_base = data.data() + begin;
+                iovecs[i].iov_len = end(next + i) - begin;
+                begin = end(next + i);
+
+                messages[i] = {};
+                messages[i].msg_hdr.msg_iov = &iovecs[i];
+                messages[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            // A failed datagram stops the call: skip it and carry on with the rest
+            for (std::size_t sent = 0; sent < batch;) {
+                const int n = sendmmsg(fd, messages.data() + sent, static_cast<unsigned int>(batch - sent), 0);
+                if (n <= 0) {
+                    stats.failedDatagrams++;
+                    sent++;
+                    continue;
+                }
+
+                for (int i = 0; i < n; i++) {
+                    stats.bytes += iovecs[sent + static_cast<std::size_t>(i)].iov_len;
+                }
+                stats.datagrams += static_cast<std::size_t>(n);
+                sent += static_cast<std::size_t>(n);
+            }
+            next += batch;
+        }
+#else
+        for (; next < count; next++) {
+            const std::size_t length = end(next) - begin;
+            if (::send(fd, data.data() + begin, length, 0) < 0) {
+                stats.failedDatagrams++;
+            } else {
+                stats.datagrams++;
+                stats.bytes += length;
+            }
+            begin = end(next);
+        }
+#endif
+
+        data.erase(0, begin);
+        if (count >= ends.size()) {
+            ends.clear();
+            datagramStart = 0;
+        } else {
+            ends.erase(ends.begin(), ends.begin() + static_cast<std::ptrdiff_t>(count));
+            for (auto& offset: ends) {
+                offset -= begin;
+            }
+            datagramStart -= begin;
+        }
+#else
+        (void)count;
+#endif
+    }
+};
+
+DatagramSink::DatagramSink()
+{
+}
+
+DatagramSink::DatagramSink(const std::string& address, const DatagramOptions& options)
+    : d_(new Priv)
+{
+#if defined(_WIN32)
+    (void)address;
+    (void)options;
+    throw InfluxError("Datagram sinks are not supported on this platform");
+#else
+    if (address.starts_with(UDP_SCHEME)) {
+        d_->fd = ConnectUdp(std::string_view(address).substr(UDP_SCHEME.size()));
+    } else if (address.starts_with(UNIXGRAM_SCHEME)) {
+        d_->fd = ConnectUnix(std::string_view(address).substr(UNIXGRAM_SCHEME.size()));
+    } else {
+        throw InfluxError("Datagram address must start with udp:// or unixgram://");
+    }
+
+    d_->options = options;
+    d_->options.maxDatagramSize = std::max<std::size_t>(options.maxDatagramSize, 1);
+    d_->options.batchDatagrams = std::max<std::size_t>(options.batchDatagrams, 1);
+#endif
+}
+
+DatagramSink::DatagramSink(DatagramSink&& other)
+    : d_(std::move(other.d_))
+{
+}
+
+DatagramSink& DatagramSink::operator=(DatagramSink&& other)
+{
+    d_ = std::move(other.d_);
+    return *this;
+}
+
+DatagramSink::~DatagramSink()
+{
+    if (d_) {
+        d_->send(d_->data.empty() ? 0 : d_->ends.size() + 1);
+    }
+}
+
+DatagramSink::operator bool() const
+{
+    return d_ != nullptr;
+}
+
+void DatagramSink::Write(const Measurement& measurement)
+{
+    if (!d_) {
+        throw InfluxError("Cannot write to a null datagram sink");
+    }
+    d_->push(measurement);
+}
+
+void DatagramSink::Write(const std::vector<Measurement>& measurements)
+{
+    for (const auto& measurement: measurements) {
+        Write(measurement);
+    }
+}
+
+void DatagramSink::Write(const PointView& point)
+{
+    if (!d_) {
+        throw InfluxError("Cannot write to a null datagram sink");
+    }
+    d_->push(point);
+}
+
+void DatagramSink::Flush()
+{
+    if (!d_) {
+        throw InfluxError("Cannot write to a null datagram sink");
+    }
+    d_->send(d_->data.empty() ? 0 : d_->ends.size() + 1);
+}
+
+std::size_t DatagramSink::BufferedBytes() const
+{
+    return d_ ? d_->data.size() : 0;
+}
+
+DatagramStats DatagramSink::stats() const
+{
+    return d_ ? d_->stats : DatagramStats{};
+}
+
+} // namespace
+
+influx::DatagramSink& operator<<(influx::DatagramSink& sink, const influx::Measurement& measurement)
+{
+    sink.Write(measurement);
+    return sink;
+}
+
+influx::DatagramSink& operator<<(influx::DatagramSink& sink, const influx::PointView& point)
+{
+    sink.Write(point);
+    return sink;
+}
@@ -0,0 +1,169 @@
+#include <algorithm>
+
+#include <cstdlib>
+
+#include "flux_csv.hh"
+#include "line_protocol.hh"
+#include "rfc3339.hh"
+
+namespace influx {
+
+namespace {
+    const std::size_t NONE = static_cast<std::size_t>(-1);
+}
+
+void SplitCsvCells(std::string_view line, std::vector<std::string_view>& cells, std::string& scratch)
+{
+    cells.clear();
+    scratch.clear();
+    scratch.reserve(line.size());
+
+    std::size_t pos = 0;
+    for (;;) {
+        if (pos < line.size() && line[pos] == '"') {
+            const std::size_t start = scratch.size();
+            for (pos++; pos < line.size(); pos++) {
+                if (line[pos] == '"') {
+                    if (pos + 1 < line.size() && line[pos + 1] == '"') {
+                        pos++;
+                    } else {
+                        pos++;
+                        break;
+                    }
+                }
+                scratch.push_back(line[pos]);
+            }
+            cells.push_back(std::string_view(scratch).substr(start));
+            pos = std::min(line.find(',', pos), line.size());
+        } else {
+            const std::size_t end = std::min(line.find(',', pos), line.size());
+            cells.push_back(line.substr(pos, end - pos));
+            pos = end;
+        }
+
+        if (pos == line.size()) {
+            break;
+        }
+        pos++;
+    }
+}
+
+bool IsFluxErrorHeader(const std::vector<std::string_view>& cells)
+{
+    return (cells.size() == 2 || cells.size() == 3) && cells[1] == "error" && (cells.size() == 2 || cells[2] == "reference");
+}
+
+double ParseFluxDouble(std::string_view cell, std::string& number)
+{
+    number.assign(cell);
+
+    char* end;
+    const double value = std::strtod(number.c_str(), &end);
+    if (cell.empty() || end != number.c_str() + number.size()) {
+        throw InfluxError("Invalid float in query response");
+    }
+    return value;
+}
+
+CsvToLineProtocol::CsvToLineProtocol(const transport::BodySink& sink)
+    : sink_(sink)
+    , reader_(
+        [this](const auto& columns) { layout(columns); },
+        [this](const auto& cells, bool) { row(cells); }
+    )
+{
+}
+
+void CsvToLineProtocol::feed(std::string_view data)
+{
+    reader_.feed(data);
+
+    if (!out_.empty()) {
+        sink_(out_);
+        out_.clear();
+    }
+}
+
+void CsvToLineProtocol::finish()
+{
+    reader_.finish();
+
+    if (!out_.empty()) {
+        sink_(out_);
+        out_.clear();
+    }
+}
+
+void CsvToLineProtocol::layout(const std::vector<FluxCsvReader::Column>& columns)
+{
+    columns_ = columns;
+    measurement_ = field_ = value_ = time_ = NONE;
+    tags_.clear();
+
+    for (std::size_t i = 0; i < columns_.size(); i++) {
+        const std::string& name = columns_[i].name;
+
+        if (name == "_measurement") {
+            measurement_ = i;
+        } else if (name == "_field") {
+            field_ = i;
+        } else if (name == "_value") {
+            value_ = i;
+        } else if (name == "_time") {
+            time_ = i;
+        } else if (!name.empty() && name[0] != '_' && name != "result" && name != "table") {
+            tags_.push_back(i);
+        }
+    }
+
+    std::sort(tags_.begin(), tags_.end(), [&](std::size_t lhs, std::size_t rhs) { return columns_[lhs].name < columns_[rhs].name; });
+}
+
+void CsvToLineProtocol::row(const std::vector<std::string_view>& cells)
+{
+    if (measurement_ == NONE || field_ == NONE || value_ == NONE || time_ == NONE) {
+        throw InfluxError("Query result lacks the _measurement, _field, _value or _time columns of line protocol");
+    }
+
+    const std::string_view value = cells[value_];
+    if (value.empty()) {
+        return;
+    }
+
+    lp::AppendEscaped(out_, cells[measurement_], " ,");
+
+    for (std::size_t tag: tags_) {
+        if (!cells[tag].empty()) {
+            out_.push_back(',');
+            lp::AppendEscaped(out_, columns_[tag].name, " =,");
+            out_.push_back('=');
+            lp::AppendEscaped(out_, cells[tag], " =,");
+        }
+    }
+
+    out_.push_back(' ');
+    lp::AppendEscaped(out_, cells[field_], " =,");
+    out_.push_back('=');
+
+    const std::string_view type = columns_[value_].type;
+    if (type == "double" || type == "boolean") {
+        out_.append(value);
+    } else if (type == "long") {
+        out_.append(value);
+        out_.push_back('i');
+    } else if (type == "unsignedLong") {
+        out_.append(value);
+        out_.push_back('u');
+    } else if (type.starts_with("dateTime")) {
+        lp::AppendTimestamp(out_, ParseRFC3339(value));
+        out_.push_back('i');
+    } else {
+        lp::AppendFieldValue(out_, FieldValueView(value));
+    }
+
+    out_.push_back(' ');
+    lp::AppendTimestamp(out_, ParseRFC3339(cells[time_]));
+    out_.push_back('\n');
+}
+
+} // namespace
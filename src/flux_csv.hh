@@ -0,0 +1,60 @@
+#ifndef INFLUX__FLUX_CSV_HH_
+#define INFLUX__FLUX_CSV_HH_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <influx/client.hh>
+#include <influx/flux_rows.hh>
+
+namespace influx {
+
+/* Split line on commas outside of quotes into cells, unquoting those that
+ * need it into scratch. scratch is reserved to the line's length first so
+ * the views into it stay valid. */
+void SplitCsvCells(std::string_view line, std::vector<std::string_view>& cells, std::string& scratch);
+
+/* Whether header cells, the leading annotation column included, are those of
+ * the table InfluxDB reports a failed query in: error, then reference. An
+ * error column among others is just a tag. */
+bool IsFluxErrorHeader(const std::vector<std::string_view>& cells);
+
+/* Value of a double cell, +Inf, -Inf and NaN included. number holds a
+ * NUL-terminated copy of it. Throws InfluxError if the cell is no number. */
+double ParseFluxDouble(std::string_view cell, std::string& number);
+
+/* Converts a Flux annotated CSV response, fed in arbitrary pieces, to line
+ * protocol (precision=ns) handed to sink once per piece. Rows need
+ * _measurement, _field, _value and _time columns; other columns not starting
+ * with an underscore become tags. Rows with a null value are skipped. */
+class CsvToLineProtocol {
+public:
+    explicit CsvToLineProtocol(const transport::BodySink& sink);
+
+    void feed(std::string_view data);
+
+    /* Convert a last line lacking its line break */
+    void finish();
+
+private:
+    void layout(const std::vector<FluxCsvReader::Column>& columns);
+    void row(const std::vector<std::string_view>& cells);
+
+    const transport::BodySink& sink_;
+    FluxCsvReader reader_;
+
+    // Current table layout
+    std::vector<FluxCsvReader::Column> columns_;
+    std::size_t measurement_;
+    std::size_t field_;
+    std::size_t value_;
+    std::size_t time_;
+    std::vector<std::size_t> tags_;
+
+    std::string out_;
+};
+
+} // namespace
+
+#endif
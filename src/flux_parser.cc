@@ -1,169 +1,286 @@
-#include <iostream>
-#include <iomanip>
-#include <chrono>
-#include <sstream>
-
-#include <cassert>
-#include <cstring>
-#include <ctime>
-
-#if (defined _MSC_VER)
-#include <windows.h>
-#include <timezoneapi.h>
-#endif
+#include <algorithm>
+#include <charconv>
+#include <ostream>
 
 #include <influx/flux_parser.hh>
+#include <influx/flux_rows.hh>
+
+#include "flux_csv.hh"
+#include "rfc3339.hh"
 
 namespace influx {
 
 namespace {
-    const char * const ANNOTATION_DATATYPE = "#datatype";
+    enum class Role {
+        Result,
+        Table,
+        Start,
+        Stop,
+        Time,
+        Value,
+        Field,
+        Measurement,
+        Tag
+    };
+
+    enum class Type {
+        Double,
+        Boolean,
+        UnsignedLong,
+        Long,
+        String
+    };
 
     struct Column {
         std::string name;
-        std::string type;
+        Type type = Type::String;
+        Role role = Role::Tag;
     };
 
-    std::chrono::seconds tzbias()
+    Type ParseType(std::string_view type)
     {
-#if (defined _MSC_VER)
-        TIME_ZONE_INFORMATION tzinfo;
-        GetTimeZoneInformation(&tzinfo);
-        return std::chrono::seconds(tzinfo.Bias * 60);
-#else
-        return std::chrono::seconds(timezone);
-#endif
+        if (type == "double") return Type::Double;
+        if (type == "boolean") return Type::Boolean;
+        if (type == "unsignedLong") return Type::UnsignedLong;
+        if (type == "long") return Type::Long;
+        return Type::String;
     }
 
-    Timestamp parseRFC3339(const std::string& str)
+    Role ParseRole(std::string_view name)
     {
-        std::istringstream ss(str);
-        struct std::tm tm;
-        std::memset(&tm, 0, sizeof(struct tm));
-
-        ss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
-        time_t timestamp = mktime(&tm) - tzbias().count();
+        if (name == "result") return Role::Result;
+        if (name == "table") return Role::Table;
+        if (name == "_start") return Role::Start;
+        if (name == "_stop") return Role::Stop;
+        if (name == "_time") return Role::Time;
+        if (name == "_value") return Role::Value;
+        if (name == "_field") return Role::Field;
+        if (name == "_measurement") return Role::Measurement;
+        return Role::Tag;
+    }
 
-        double frac = 0;
-        ss >> frac;
-        auto nano = static_cast<std::uint64_t>(frac * 1e9);
-        return Clock::from_time_t(timestamp) + std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(nano));
+    template <typename Integer>
+    Integer ParseInteger(std::string_view token)
+    {
+        Integer value = 0;
+        auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+        if (error != std::errc() || end != token.data() + token.size()) {
+            throw InfluxError("Invalid integer in Flux response");
+        }
+        return value;
     }
 }
 
-std::vector<FluxTable> FluxParser::parse(const std::string& body)
+InternedString::InternedString()
+{
+    // Shared by every empty string, so that default records allocate nothing
+    static const std::shared_ptr<const std::string> empty = std::make_shared<const std::string>();
+    value_ = empty;
+}
+
+InternedString::InternedString(std::string value)
+    : value_(std::make_shared<const std::string>(std::move(value)))
+{
+}
+
+InternedString::InternedString(const char* value)
+    : InternedString(std::string(value))
+{
+}
+
+std::ostream& operator<<(std::ostream& os, const InternedString& string)
 {
-    std::stringstream ssbody(body);
+    return os << string.str();
+}
+
+FluxTags::FluxTags()
+{
+    static const std::shared_ptr<const Map> empty = std::make_shared<const Map>();
+    tags_ = empty;
+}
+
+FluxTags::FluxTags(Map tags)
+    : tags_(std::make_shared<const Map>(std::move(tags)))
+{
+}
 
+struct FluxParser::Priv {
     std::vector<FluxTable> tables;
 
     std::vector<Column> columns;
     FluxTable table;
-    int current_table_id = -1;
-    bool new_table = false;
 
-    for (std::string line; std::getline(ssbody, line);) {
-        if (line.ends_with("\r")) {
-            line = line.substr(0, line.size() - 1);
-        }
+    FluxCsvReader reader{
+        [this](const auto& header) { layout(header); },
+        [this](const auto& cells, bool newTable) { read(cells, newTable); }
+    };
 
-        if (line.empty()) {
-            continue;
-        } else if (line.starts_with(ANNOTATION_DATATYPE)) {
-            if (!table.empty()) {
-                tables.emplace_back(std::move(table));
-            }
-
-            columns.clear();
-            table.clear();
-            new_table = true;
-
-            std::stringstream ssline(std::move(line));
-            for (std::string token = ""; std::getline(ssline, token, ',');) {
-                if (token.empty() || token == ANNOTATION_DATATYPE) {
-                    continue;
-                }
+    // Strings of the response seen so far, shared by the records holding them
+    std::unordered_map<std::string_view, InternedString> interned;
 
-                columns.emplace_back("", token);
-            }
-        } else if (line.starts_with("#")) {
-            continue;
-        } else if (new_table) {
-            std::stringstream ssline(std::move(line));
-            std::size_t i = 0;
+    // Tag cells of the last row and the tags built from them, reused while
+    // rows repeat them: group key columns do, throughout a table
+    std::vector<std::pair<std::size_t, std::string>> lastTagCells;
+    std::vector<std::pair<std::size_t, std::string_view>> tagCells;
+    FluxTags lastTags;
 
-            for (std::string token = ""; std::getline(ssline, token, ','); i++) {
-                if (token.empty()) {
-                    continue;
-                }
+    std::string number;  // scratch of ParseFluxDouble
 
-                columns[i - 1].name = std::move(token);
-            }
-            new_table = false;
-        } else {
-            std::stringstream ssline(std::move(line));
-            std::size_t i = 0;
+    const InternedString& intern(std::string_view value);
+    const FluxTags& tags();
+    void layout(const std::vector<FluxCsvReader::Column>& header);
+    void read(const std::vector<std::string_view>& cells, bool newTable);
+};
 
-            FluxRecord record;
+const InternedString& FluxParser::Priv::intern(std::string_view value)
+{
+    auto it = interned.find(value);
+    if (it == interned.end()) {
+        InternedString string{std::string(value)};
+        const std::string_view key = string;  // points into the shared storage
+        it = interned.emplace(key, std::move(string)).first;
+    }
+    return it->second;
+}
 
-            for (std::string token = ""; std::getline(ssline, token, ','); i++) {
-                if (token.empty()) {
-                    continue;
-                }
+const FluxTags& FluxParser::Priv::tags()
+{
+    const bool same = tagCells.size() == lastTagCells.size()
+        && std::equal(tagCells.begin(), tagCells.end(), lastTagCells.begin(), [](const auto& cell, const auto& last) {
+            return cell.first == last.first && cell.second == last.second;
+        });
 
-                if (i > columns.size()) {
-                    assert(false);
-                }
+    if (!same) {
+        FluxTags::Map map;
+        lastTagCells.resize(tagCells.size());
+        for (std::size_t i = 0; i < tagCells.size(); i++) {
+            map.emplace(columns[tagCells[i].first].name, tagCells[i].second);
+            lastTagCells[i].first = tagCells[i].first;
+            lastTagCells[i].second.assign(tagCells[i].second);
+        }
+        lastTags = FluxTags(std::move(map));
+    }
+    return lastTags;
+}
+
+void FluxParser::Priv::layout(const std::vector<FluxCsvReader::Column>& header)
+{
+    columns.clear();
+    for (const FluxCsvReader::Column& column: header) {
+        columns.push_back({column.name, ParseType(column.type), ParseRole(column.name)});
+    }
+
+    lastTagCells.clear();
+    lastTags = FluxTags();
+}
+
+void FluxParser::Priv::read(const std::vector<std::string_view>& cells, bool newTable)
+{
+    if (newTable && !table.empty()) {
+        tables.push_back(std::move(table));
+        table.clear();
+    }
+
+    FluxRecord record;
+    tagCells.clear();
+
+    for (std::size_t i = 0; i < cells.size(); i++) {
+        const std::string_view token = cells[i];
+        if (token.empty()) {
+            continue;
+        }
 
-                if (columns[i - 1].name == "result") {
-                    record.name = token;
-                } else if (columns[i - 1].name == "table") {
-                    int table_id = std::stoi(token);
-
-                    // New table but column definition has stayed the same
-                    if (current_table_id != table_id) {
-                        if (!table.empty()) {
-                            tables.push_back(std::move(table));
-                        }
-                        table.clear();
-                        current_table_id = table_id;
-                    }
-                } else if (columns[i - 1].name == "_start") {
-                    record.start = parseRFC3339(token);
-                } else if (columns[i - 1].name == "_stop") {
-                    record.stop = parseRFC3339(token);
-                } else if (columns[i - 1].name == "_time") {
-                    record.time = parseRFC3339(token);
-                } else if (columns[i - 1].name == "_value") {
-                    if (columns[i - 1].type == "double") {
-                        record.value = std::stod(token);
-                    } else if (columns[i - 1].type == "boolean") {
+        const Column& column = columns[i];
+        switch (column.role) {
+            case Role::Result:
+                record.name = intern(token);
+                break;
+            case Role::Table:
+                break;
+            case Role::Start:
+                record.start = ParseRFC3339(token);
+                break;
+            case Role::Stop:
+                record.stop = ParseRFC3339(token);
+                break;
+            case Role::Time:
+                record.time = ParseRFC3339(token);
+                break;
+            case Role::Value:
+                switch (column.type) {
+                    case Type::Double:
+                        record.value = ParseFluxDouble(token, number);
+                        break;
+                    case Type::Boolean:
                         record.value = (token == "true");
-                    } else if (columns[i - 1].type == "unsignedLong") {
-                        // GCC and MSVC disagree on what a long long is
-                        record.value = static_cast<std::uint64_t>(std::stoull(token));
-                    } else if (columns[i - 1].type == "long") {
-                        record.value = static_cast<std::int64_t>(std::stoll(token));
-                    } else {
-                        record.value = token;
-                    }
-                } else if (columns[i - 1].name == "_field") {
-                    record.field = token;
-                } else if (columns[i - 1].name == "_measurement") {
-                    record.measurement = token;
-                } else {
-                    record.tags[columns[i - 1].name] = token;
+                        break;
+                    case Type::UnsignedLong:
+                        record.value = ParseInteger<std::uint64_t>(token);
+                        break;
+                    case Type::Long:
+                        record.value = ParseInteger<std::int64_t>(token);
+                        break;
+                    default:
+                        record.value = std::string(token);
                 }
-            }
-
-            table.emplace_back(std::move(record));
+                break;
+            case Role::Field:
+                record.field = intern(token);
+                break;
+            case Role::Measurement:
+                record.measurement = intern(token);
+                break;
+            default:
+                tagCells.emplace_back(i, token);
         }
     }
 
-    if (!table.empty()) {
-        tables.push_back(std::move(table));
+    record.tags = tags();
+    table.emplace_back(std::move(record));
+}
+
+FluxParser::FluxParser()
+    : d_(new Priv)
+{
+}
+
+FluxParser::FluxParser(FluxParser&& other)
+    : d_(new Priv)
+{
+    d_.swap(other.d_);
+}
+
+FluxParser& FluxParser::operator=(FluxParser&& other)
+{
+    d_.swap(other.d_);
+    return *this;
+}
+
+FluxParser::~FluxParser()
+{
+}
+
+std::vector<FluxTable> FluxParser::parse(const std::string& body)
+{
+    feed(body);
+    return finish();
+}
+
+void FluxParser::feed(std::string_view data)
+{
+    d_->reader.feed(data);
+}
+
+std::vector<FluxTable> FluxParser::finish()
+{
+    d_->reader.finish();
+
+    if (!d_->table.empty()) {
+        d_->tables.push_back(std::move(d_->table));
     }
 
+    std::vector<FluxTable> tables = std::move(d_->tables);
+    d_.reset(new Priv);
     return tables;
 }
 
@@ -0,0 +1,197 @@
+#include <charconv>
+
+#include <influx/flux_rows.hh>
+
+#include "flux_csv.hh"
+#include "rfc3339.hh"
+
+namespace influx {
+
+namespace {
+    const std::size_t NONE = static_cast<std::size_t>(-1);
+
+    template <typename Integer>
+    void ParseInteger(std::string_view cell, Integer& out)
+    {
+        auto [end, error] = std::from_chars(cell.data(), cell.data() + cell.size(), out);
+        if (error != std::errc() || end != cell.data() + cell.size()) {
+            throw InfluxError("Invalid integer in query response");
+        }
+    }
+}
+
+struct FluxCsvReader::Priv {
+    LayoutHandler layout;
+    RowHandler row;
+
+    std::string partial;
+    bool quoted = false;
+
+    // Cells of the current line, unquoted into scratch when needed
+    std::vector<std::string_view> cells;
+    std::string scratch;
+
+    // Current table layout, without the annotation column
+    bool expectHeader = true;
+    std::vector<std::string> types;
+    std::vector<Column> columns;
+    std::size_t table = NONE;
+    std::size_t error = NONE;
+    std::string currentTable;
+    bool newTable = true;
+
+    void line(std::string_view line);
+    void header();
+    void read();
+};
+
+void FluxCsvReader::Priv::line(std::string_view line)
+{
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+
+    // Tables are separated by a blank line, then annotations and a header
+    if (line.empty()) {
+        expectHeader = true;
+        return;
+    }
+
+    SplitCsvCells(line, cells, scratch);
+
+    if (cells[0] == "#datatype") {
+        types.assign(cells.begin() + 1, cells.end());
+        expectHeader = true;
+    } else if (!cells[0].empty() && cells[0][0] == '#') {
+        return;
+    } else if (expectHeader) {
+        header();
+        expectHeader = false;
+    } else {
+        read();
+    }
+}
+
+void FluxCsvReader::Priv::header()
+{
+    columns.clear();
+    table = NONE;
+    error = IsFluxErrorHeader(cells) ? 0 : NONE;
+
+    for (std::size_t i = 1; i < cells.size(); i++) {
+        columns.push_back({std::string(cells[i]), i - 1 < types.size() ? types[i - 1] : std::string()});
+
+        if (cells[i] == "table") {
+            table = i - 1;
+        }
+    }
+
+    newTable = true;
+    if (error == NONE) {
+        layout(columns);
+    }
+}
+
+void FluxCsvReader::Priv::read()
+{
+    // The leading annotation column is left out
+    cells.erase(cells.begin());
+
+    // Failures past the response headers come as a table of their own
+    if (error != NONE) {
+        throw InfluxRemoteError(200, std::string(error < cells.size() ? cells[error] : "Query failed"));
+    }
+
+    if (cells.size() != columns.size()) {
+        throw InfluxError("Malformed query response");
+    }
+
+    if (table != NONE && cells[table] != currentTable) {
+        currentTable.assign(cells[table]);
+        newTable = true;
+    }
+
+    row(cells, newTable);
+    newTable = false;
+}
+
+FluxCsvReader::FluxCsvReader(LayoutHandler layout, RowHandler row)
+    : d_(new Priv{std::move(layout), std::move(row)})
+{
+}
+
+FluxCsvReader::~FluxCsvReader()
+{
+}
+
+void FluxCsvReader::feed(std::string_view data)
+{
+    std::size_t start = 0;
+
+    for (std::size_t i = 0; i < data.size(); i++) {
+        if (data[i] == '"') {
+            d_->quoted = !d_->quoted;
+        } else if (data[i] == '\n' && !d_->quoted) {
+            if (d_->partial.empty()) {
+                d_->line(data.substr(start, i - start));
+            } else {
+                d_->partial.append(data.substr(start, i - start));
+                d_->line(d_->partial);
+                d_->partial.clear();
+            }
+            start = i + 1;
+        }
+    }
+    d_->partial.append(data.substr(start));
+}
+
+void FluxCsvReader::finish()
+{
+    if (!d_->partial.empty()) {
+        d_->line(d_->partial);
+        d_->partial.clear();
+    }
+
+    d_->quoted = false;
+    d_->expectHeader = true;
+    d_->currentTable.clear();
+}
+
+bool FluxTypeMatches(std::string_view type, std::string_view expected)
+{
+    // dateTime:RFC3339, dateTime:RFC3339Nano...
+    return type == expected || (type.starts_with(expected) && type[expected.size()] == ':');
+}
+
+void DecodeFluxCell(std::string_view cell, Timestamp& out)
+{
+    out = ParseRFC3339(cell);
+}
+
+void DecodeFluxCell(std::string_view cell, double& out)
+{
+    thread_local std::string number;
+    out = ParseFluxDouble(cell, number);
+}
+
+void DecodeFluxCell(std::string_view cell, std::int64_t& out)
+{
+    ParseInteger(cell, out);
+}
+
+void DecodeFluxCell(std::string_view cell, std::uint64_t& out)
+{
+    ParseInteger(cell, out);
+}
+
+void DecodeFluxCell(std::string_view cell, bool& out)
+{
+    out = cell == "true";
+}
+
+void DecodeFluxCell(std::string_view cell, std::string& out)
+{
+    out.assign(cell);
+}
+
+} // namespace
@@ -0,0 +1,62 @@
+#include <algorithm>
+
+#include <zlib.h>
+
+#include <influx/types.hh>
+
+#include "gzip.hh"
+#include "util.hh"
+
+namespace influx {
+
+namespace {
+    // Window bits selecting the gzip wrapper instead of zlib's
+    const int GZIP_WINDOW_BITS = 15 + 16;
+
+    // zlib counts in uInt and uLong, 32 bits on some platforms: larger
+    // buffers are fed in slices
+    const std::size_t SLICE = std::size_t(1) << 30;
+}
+
+std::string Gzip(std::string_view data, int level)
+{
+    z_stream stream{};
+    if (deflateInit2(&stream, level, Z_DEFLATED, GZIP_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw InfluxError("Cannot initialize gzip compression");
+    }
+    auto _ = finally([&]() { deflateEnd(&stream); });
+
+    std::string out(deflateBound(&stream, static_cast<uLong>(std::min(data.size(), SLICE))), '\0');
+    std::size_t read = 0;
+    std::size_t written = 0;
+
+    for (;;) {
+        if (stream.avail_in == 0 && read < data.size()) {
+            const std::size_t slice = std::min(data.size() - read, SLICE);
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data() + read));
+            stream.avail_in = static_cast<uInt>(slice);
+            read += slice;
+        }
+
+        if (written == out.size()) {
+            out.resize(out.size() * 2);
+        }
+        const std::size_t room = std::min(out.size() - written, SLICE);
+        stream.next_out = reinterpret_cast<Bytef*>(out.data() + written);
+        stream.avail_out = static_cast<uInt>(room);
+
+        const int result = deflate(&stream, read == data.size() ? Z_FINISH : Z_NO_FLUSH);
+        written += room - stream.avail_out;
+
+        if (result == Z_STREAM_END) {
+            break;
+        } else if (result != Z_OK && result != Z_BUF_ERROR) {
+            throw InfluxError("Cannot gzip data");
+        }
+    }
+
+    out.resize(written);
+    return out;
+}
+
+} // namespace
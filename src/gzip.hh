@@ -0,0 +1,15 @@
+#ifndef INFLUX__GZIP_HH_
+#define INFLUX__GZIP_HH_
+
+#include <string>
+#include <string_view>
+
+namespace influx {
+
+/* Compress data in a single gzip member, level 1 (fastest) to 9 (smallest).
+ * Throws InfluxError if zlib fails. */
+std::string Gzip(std::string_view data, int level);
+
+} // namespace
+
+#endif
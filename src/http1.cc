@@ -0,0 +1,450 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <optional>
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "http1.hh"
+#include "util.hh"
+
+namespace influx::transport {
+
+namespace {
+    const std::string_view HTTP_SCHEME = "http://";
+
+    // Granularity at which cancellation is noticed while waiting on the socket
+    const int POLL_SLICE_MS = 100;
+
+    bool StartsWithNoCase(std::string_view str, std::string_view prefix)
+    {
+        return str.size() >= prefix.size() && std::equal(prefix.begin(), prefix.end(), str.begin(), [](char a, char b) {
+            return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+        });
+    }
+
+    /* Value of header name in head (without the status line), if present */
+    std::optional<std::string_view> HeaderValue(std::string_view head, std::string_view name)
+    {
+        for (std::size_t pos = 0; pos < head.size();) {
+            std::size_t end = head.find("\r\n", pos);
+            if (end == std::string_view::npos) {
+                end = head.size();
+            }
+
+            std::string_view line = head.substr(pos, end - pos);
+            if (StartsWithNoCase(line, name) && line.size() > name.size() && line[name.size()] == ':') {
+                std::string_view value = line.substr(name.size() + 1);
+                value.remove_prefix(std::min(value.find_first_not_of(" \t"), value.size()));
+                return value;
+            }
+            pos = end + 2;
+        }
+        return std::nullopt;
+    }
+
+    /* Content-Length (base 10) or chunk size (base 16) at the start of value,
+     * up to whitespace or a chunk extension */
+    std::size_t ParseLength(std::string_view value, int base)
+    {
+        std::size_t length = 0;
+        const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), length, base);
+        if (error != std::errc() || (end != value.data() + value.size() && *end != ' ' && *end != '\t' && *end != ';')) {
+            throw InfluxError("Invalid response from server");
+        }
+        return length;
+    }
+}
+
+struct Http1Connection::Deadline {
+    std::optional<std::chrono::steady_clock::time_point> at;
+    const std::optional<CancellationToken>& cancellation;
+
+    /* Milliseconds to wait for at most, throwing once past */
+    int slice() const
+    {
+        if (cancellation && cancellation->cancelled()) {
+            throw CancelledError();
+        }
+
+        if (!at) {
+            return POLL_SLICE_MS;
+        }
+
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(*at - std::chrono::steady_clock::now()).count();
+        if (left <= 0) {
+            throw TimeoutError();
+        }
+        return static_cast<int>(std::min<long long>(left, POLL_SLICE_MS));
+    }
+};
+
+std::string Http1Head(std::string_view url, const std::vector<std::string>& headers)
+{
+    Http1Authority(url);  // validates the scheme
+
+    url.remove_prefix(HTTP_SCHEME.size());
+    const std::size_t slash = url.find('/');
+    const std::string_view target = slash == std::string_view::npos ? "/" : url.substr(slash);
+    const std::string_view authority = url.substr(0, slash);
+
+    std::string head;
+    head.append("POST ").append(target).append(" HTTP/1.1\r\n");
+    head.append("Host: ").append(authority).append("\r\n");
+    for (const auto& header: headers) {
+        head.append(header).append("\r\n");
+    }
+    return head;
+}
+
+std::pair<std::string, std::string> Http1Authority(std::string_view url)
+{
+    if (!StartsWithNoCase(url, HTTP_SCHEME)) {
+        throw InfluxError("Native transport only supports http:// and unix:// hosts");
+    }
+
+    url.remove_prefix(HTTP_SCHEME.size());
+    std::string_view authority = url.substr(0, url.find('/'));
+
+    // [v6 address]:port
+    if (authority.starts_with('[')) {
+        const std::size_t bracket = authority.find(']');
+        if (bracket == std::string_view::npos) {
+            throw InfluxError("Invalid host");
+        }
+        const std::string_view port = authority.substr(bracket + 1);
+        return {std::string(authority.substr(1, bracket - 1)), port.starts_with(':') ? std::string(port.substr(1)) : "80"};
+    }
+
+    const std::size_t colon = authority.rfind(':');
+    if (colon == std::string_view::npos) {
+        return {std::string(authority), "80"};
+    }
+    return {std::string(authority.substr(0, colon)), std::string(authority.substr(colon + 1))};
+}
+
+#if defined(_WIN32)
+
+Http1Connection::Http1Connection(std::string, std::string, std::string)
+{
+    throw InfluxError("Native transport is not supported on this platform");
+}
+
+Http1Connection::~Http1Connection()
+{
+}
+
+HttpResponse Http1Connection::post(const std::string&, const std::vector<std::string_view>&, const RequestOptions&)
+{
+    throw InfluxError("Native transport is not supported on this platform");
+}
+
+#else
+
+Http1Connection::Http1Connection(std::string host, std::string port, std::string socketPath)
+    : host_(std::move(host))
+    , port_(std::move(port))
+    , socketPath_(std::move(socketPath))
+{
+}
+
+Http1Connection::~Http1Connection()
+{
+    close();
+}
+
+void Http1Connection::close()
+{
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void Http1Connection::connect(const Deadline& deadline)
+{
+    // Connecting is bounded by connectTimeout as well as the total timeout
+    auto attempt = [&](int family, const struct sockaddr* addr, socklen_t length) {
+        const int fd = socket(family, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return false;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+        const int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+        if (::connect(fd, addr, length) != 0 && errno != EINPROGRESS) {
+            ::close(fd);
+            return false;
+        }
+
+        try {
+            struct pollfd pfd = {fd, POLLOUT, 0};
+            int ready;
+            while ((ready = poll(&pfd, 1, deadline.slice())) == 0 || (ready < 0 && errno == EINTR)) {
+            }
+
+            if (ready < 0) {
+                ::close(fd);
+                return false;
+            }
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+
+        int error = 0;
+        socklen_t size = sizeof(error);
+        if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &size) != 0 || error != 0) {
+            ::close(fd);
+            return false;
+        }
+
+        fd_ = fd;
+        return true;
+    };
+
+    if (!socketPath_.empty()) {
+        struct sockaddr_un addr = {};
+        if (socketPath_.size() >= sizeof(addr.sun_path)) {
+            throw InfluxError("Invalid Unix socket path");
+        }
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, socketPath_.data(), socketPath_.size());
+
+        if (!attempt(AF_UNIX, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr))) {
+            throw InfluxError("Cannot connect to server");
+        }
+        return;
+    }
+
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo* results = nullptr;
+    if (getaddrinfo(host_.c_str(), port_.c_str(), &hints, &results) != 0) {
+        throw InfluxError("Cannot resolve host");
+    }
+    auto _ = finally([&]() { freeaddrinfo(results); });
+
+    for (struct addrinfo* result = results; result; result = result->ai_next) {
+        if (attempt(result->ai_family, result->ai_addr, result->ai_addrlen)) {
+            return;
+        }
+    }
+    throw InfluxError("Cannot connect to server");
+}
+
+void Http1Connection::send(std::vector<std::string_view> pieces, const Deadline& deadline)
+{
+    std::vector<struct iovec> iovecs;
+    iovecs.reserve(pieces.size());
+    for (const auto& piece: pieces) {
+        if (!piece.empty()) {
+            iovecs.push_back({const_cast<char*>(piece.data()), piece.size()});
+        }
+    }
+
+    const std::size_t maxIovecs = static_cast<std::size_t>(std::max(sysconf(_SC_IOV_MAX), 16L));
+    std::size_t first = 0;
+
+    while (first < iovecs.size()) {
+        struct msghdr message = {};
+        message.msg_iov = iovecs.data() + first;
+        message.msg_iovlen = std::min(iovecs.size() - first, maxIovecs);
+
+#ifdef MSG_NOSIGNAL
+        const ssize_t n = sendmsg(fd_, &message, MSG_NOSIGNAL);
+#else
+        const ssize_t n = sendmsg(fd_, &message, 0);
+#endif
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                struct pollfd pfd = {fd_, POLLOUT, 0};
+                poll(&pfd, 1, deadline.slice());
+                continue;
+            }
+            throw InfluxError("Cannot send request");
+        }
+
+        // Skip what was sent, trimming a partially sent buffer
+        for (std::size_t sent = static_cast<std::size_t>(n); sent > 0 && first < iovecs.size();) {
+            auto& iovec = iovecs[first];
+            const std::size_t consumed = std::min(sent, iovec.iov_len);
+            iovec.iov_base = static_cast<char*>(iovec.iov_base) + consumed;
+            iovec.iov_len -= consumed;
+            sent -= consumed;
+            if (iovec.iov_len == 0) {
+                first++;
+            }
+        }
+    }
+}
+
+bool Http1Connection::receive(std::string& buffer, const Deadline& deadline)
+{
+    char chunk[4096];
+    while (true) {
+        const ssize_t n = recv(fd_, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            buffer.append(chunk, static_cast<std::size_t>(n));
+            return true;
+        }
+        if (n == 0) {
+            return false;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            return false;
+        }
+
+        struct pollfd pfd = {fd_, POLLIN, 0};
+        poll(&pfd, 1, deadline.slice());
+    }
+}
+
+HttpResponse Http1Connection::response(std::string& buffer, const Deadline& deadline)
+{
+    auto fill = [&](std::size_t size) {
+        while (buffer.size() < size) {
+            if (!receive(buffer, deadline)) {
+                throw InfluxError("Connection closed by server");
+            }
+        }
+    };
+
+    std::size_t headEnd;
+    while ((headEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (!receive(buffer, deadline)) {
+            throw InfluxError("Connection closed by server");
+        }
+    }
+
+    // HTTP/1.1 204 No Content
+    const std::string_view statusLine = std::string_view(buffer).substr(0, buffer.find("\r\n"));
+    if (statusLine.size() < 12 || !statusLine.starts_with("HTTP/1.")) {
+        throw InfluxError("Invalid response from server");
+    }
+    const int status = std::atoi(std::string(statusLine.substr(9, 3)).c_str());
+    const bool http10 = statusLine[7] == '0';
+
+    const std::string head = buffer.substr(statusLine.size() + 2, headEnd - statusLine.size());
+    buffer.erase(0, headEnd + 4);
+
+    // Interim response, the real one follows
+    if (status / 100 == 1) {
+        return response(buffer, deadline);
+    }
+
+    std::string body;
+    bool closed = http10;
+    if (auto connection = HeaderValue(head, "Connection")) {
+        closed = StartsWithNoCase(*connection, "close");
+    }
+
+    if (status == 204 || status == 304) {
+        // No body
+    } else if (auto length = HeaderValue(head, "Content-Length")) {
+        const std::size_t size = ParseLength(*length, 10);
+        fill(size);
+        body = buffer.substr(0, size);
+        buffer.erase(0, size);
+    } else if (auto encoding = HeaderValue(head, "Transfer-Encoding"); encoding && StartsWithNoCase(*encoding, "chunked")) {
+        while (true) {
+            std::size_t end;
+            while ((end = buffer.find("\r\n")) == std::string::npos) {
+                fill(buffer.size() + 1);
+            }
+            const std::size_t size = ParseLength(std::string_view(buffer).substr(0, end), 16);
+            fill(end + 2 + size + 2);
+            body.append(buffer, end + 2, size);
+            buffer.erase(0, end + 2 + size + 2);
+            if (size == 0) {
+                break;  // trailers are not expected
+            }
+        }
+    } else {
+        // Delimited by the end of the connection
+        while (receive(buffer, deadline)) {
+        }
+        body = std::move(buffer);
+        closed = true;
+    }
+
+    if (closed) {
+        close();
+    }
+
+    if (status / 100 > 2) {
+        throw InfluxRemoteError(status, std::move(body));
+    }
+    return {status, std::move(body)};
+}
+
+HttpResponse Http1Connection::post(const std::string& head, const std::vector<std::string_view>& body, const RequestOptions& options)
+{
+    const auto now = std::chrono::steady_clock::now();
+    Deadline total{options.timeout.count() ? std::optional(now + options.timeout) : std::nullopt, options.cancellation};
+
+    std::size_t length = 0;
+    for (const auto& piece: body) {
+        length += piece.size();
+    }
+    const std::string contentLength = "Content-Length: " + std::to_string(length) + "\r\n\r\n";
+
+    std::vector<std::string_view> pieces;
+    pieces.reserve(body.size() + 2);
+    pieces.push_back(head);
+    pieces.push_back(contentLength);
+    pieces.insert(pieces.end(), body.begin(), body.end());
+
+    // A kept-alive connection may have been closed by the server meanwhile:
+    // such a request gets retried once on a new connection
+    for (bool reused = fd_ >= 0;; reused = false) {
+        if (fd_ < 0) {
+            auto connectAt = total.at;
+            if (options.connectTimeout.count() && (!connectAt || now + options.connectTimeout < *connectAt)) {
+                connectAt = now + options.connectTimeout;
+            }
+            connect(Deadline{connectAt, options.cancellation});
+        }
+
+        std::string buffer;
+        try {
+            send(pieces, total);
+            if (!receive(buffer, total)) {
+                throw InfluxError("Connection closed by server");
+            }
+            return response(buffer, total);
+        } catch (const InfluxRemoteError&) {
+            throw;
+        } catch (const InfluxError&) {
+            close();
+            if (!reused || !buffer.empty()) {
+                throw;
+            }
+        } catch (...) {
+            close();
+            throw;
+        }
+    }
+}
+
+#endif
+
+} // namespace
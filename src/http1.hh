@@ -0,0 +1,55 @@
+#ifndef INFLUX__HTTP1_HH_
+#define INFLUX__HTTP1_HH_
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <influx/client.hh>
+#include <influx/request_options.hh>
+
+namespace influx::transport {
+
+/* Persistent plaintext HTTP/1.1 connection posting bodies with scatter-gather
+ * I/O, for the write path. Connects lazily, to host:port or to a Unix domain
+ * socket, and reconnects once if a reused connection turns out to be closed.
+ * Honours timeout, connectTimeout and cancellation of options, not the
+ * low-speed limits. Throws like HttpClient does. Not thread-safe. */
+class Http1Connection {
+public:
+    Http1Connection(std::string host, std::string port, std::string socketPath);
+    Http1Connection(const Http1Connection&) = delete;
+    Http1Connection& operator=(const Http1Connection&) = delete;
+    ~Http1Connection();
+
+    /* head is the request line and headers, without Content-Length nor the
+     * blank line ending them, see Http1Head */
+    HttpResponse post(const std::string& head, const std::vector<std::string_view>& body, const RequestOptions& options);
+
+private:
+    struct Deadline;
+
+    void connect(const Deadline& deadline);
+    void close();
+    void send(std::vector<std::string_view> pieces, const Deadline& deadline);
+    bool receive(std::string& buffer, const Deadline& deadline);
+    HttpResponse response(std::string& buffer, const Deadline& deadline);
+
+    const std::string host_;
+    const std::string port_;
+    const std::string socketPath_;
+    int fd_ = -1;
+};
+
+/* Request head of a POST to url, an absolute http:// URL, with header lines
+ * ("Name: value") */
+std::string Http1Head(std::string_view url, const std::vector<std::string>& headers);
+
+/* Split the authority of an http:// URL into host and port, 80 by default.
+ * Throws InfluxError for other schemes. */
+std::pair<std::string, std::string> Http1Authority(std::string_view url);
+
+} // namespace
+
+#endif
@@ -1,15 +1,174 @@
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+#include <cerrno>
+#include <climits>
+#include <cmath>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
 #include <nlohmann/json.hpp>
 
 #include <influx/client.hh>
 #include <influx/influx.hh>
 
+#include "flux_csv.hh"
+#include "rfc3339.hh"
+#include "util.hh"
+
 using namespace std::chrono_literals;
 
 namespace influx {
 
+namespace {
+    const std::chrono::seconds DEFAULT_BUCKET_CACHE_TTL = 60s;
+
+    // Define the record dashboards use to inject their time range
+    std::string BindTimeRange(const std::string& flux, const Timestamp& start, const Timestamp& stop)
+    {
+        return "v = {timeRangeStart: " + FormatRFC3339(start) + ", timeRangeStop: " + FormatRFC3339(stop) + "}\n" + flux;
+    }
+
+    std::string QueryBody(const std::string& flux)
+    {
+        nlohmann::json body = {
+            {"dialect", {
+                {"annotations", {"datatype"}},
+                {"dateTimeFormat", "RFC3339Nano"},
+                {"header", true}
+            }},
+            {"query", flux}
+        };
+
+        return body.dump();
+    }
+
+    std::unordered_map<std::string, std::string> QueryHeaders()
+    {
+        return {
+            {"Content-Type", "application/json"},
+            {"Accept", "application/vnd.influx.arrow"}
+        };
+    }
+
+    /* Identifies a table's series across the results of sub-range queries */
+    std::string SeriesKey(const FluxTable& table)
+    {
+        const FluxRecord& record = table.front();
+        std::map<std::string, std::string> tags(record.tags.begin(), record.tags.end());
+
+        std::string key = record.name.str() + '\0' + record.measurement.str() + '\0' + record.field.str();
+        for (const auto& [name, value]: tags) {
+            key += '\0' + name + '=' + value;
+        }
+        return key;
+    }
+
+    struct BucketMetadata {
+        std::string id;
+        std::string name;
+        std::string orgId;
+        std::chrono::steady_clock::time_point expiry;
+    };
+}
+
 struct Influx::Priv {
     transport::HttpClient client;
     const std::string org;
+    transport::RequestTemplate query = client.Prepare("/api/v2/query", QueryHeaders());
+
+    std::mutex cacheMutex;
+    std::chrono::seconds cacheTtl = DEFAULT_BUCKET_CACHE_TTL;
+    std::unordered_map<std::string, BucketMetadata> bucketsById;
+    std::unordered_map<std::string, BucketMetadata> bucketsByName;
+
+    // Write pipelines of the buckets handed out, shared by copies
+    struct Pipelines {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::weak_ptr<Bucket::Priv>> byId;
+    };
+    std::shared_ptr<Pipelines> pipelines = std::make_shared<Pipelines>();
+
+    /* Handle to the live pipeline of bucket id, or to a new one */
+    Bucket makeBucket(const std::string& id, const std::string& name, const std::string& orgId)
+    {
+        std::lock_guard<std::mutex> lock(pipelines->mutex);
+
+        auto it = pipelines->byId.find(id);
+        if (it != pipelines->byId.end()) {
+            if (auto pipeline = it->second.lock()) {
+                return Bucket(std::move(pipeline));
+            }
+        }
+
+        std::erase_if(pipelines->byId, [](const auto& entry) { return entry.second.expired(); });
+
+        Bucket bucket(id, name, orgId, transport::HttpClient(client));
+        pipelines->byId[id] = bucket.d_;
+        return bucket;
+    }
+
+    void forget(const std::string& id)
+    {
+        std::lock_guard<std::mutex> lock(pipelines->mutex);
+        pipelines->byId.erase(id);
+    }
+
+    Bucket makeBucket(const nlohmann::json& data)
+    {
+        BucketMetadata metadata{data["id"], data["name"], data["orgID"]};
+        cache(metadata);
+        return makeBucket(metadata.id, metadata.name, metadata.orgId);
+    }
+
+    std::optional<Bucket> cached(const std::unordered_map<std::string, BucketMetadata>& index, const std::string& key)
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+
+        auto it = index.find(key);
+        if (it == index.end() || it->second.expiry < std::chrono::steady_clock::now()) {
+            return std::nullopt;
+        }
+
+        return makeBucket(it->second.id, it->second.name, it->second.orgId);
+    }
+
+    void cache(BucketMetadata metadata)
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+
+        if (cacheTtl == 0s) {
+            return;
+        }
+
+        metadata.expiry = std::chrono::steady_clock::now() + cacheTtl;
+        bucketsById[metadata.id] = metadata;
+        bucketsByName[metadata.name] = std::move(metadata);
+    }
+
+    void uncache(const std::string& id, const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        bucketsById.erase(id);
+        bucketsByName.erase(name);
+    }
+
+    void clearCache()
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        bucketsById.clear();
+        bucketsByName.clear();
+    }
 };
 
 Influx::Influx(Influx&& other)
@@ -33,6 +192,8 @@ Influx::Influx(const Influx& other)
 Influx& Influx::operator=(const Influx& other)
 {
     d_.reset(new Priv{other.d_->client, other.d_->org});
+    d_->cacheTtl = other.d_->cacheTtl;
+    d_->pipelines = other.d_->pipelines;
     return *this;
 }
 
@@ -64,12 +225,7 @@ Bucket Influx::CreateBucket(const std::string& name, const std::chrono::seconds&
     auto response = d_->client.Post("/api/v2/buckets", body.dump());
     auto data = nlohmann::json::parse(response.body);
 
-    return Bucket(
-        data["id"],
-        data["name"],
-        data["orgID"],
-        transport::HttpClient(d_->client)
-    );
+    return d_->makeBucket(data);
 }
 
 Bucket Influx::GetBucketById(const std::string& id)
@@ -78,15 +234,14 @@ Bucket Influx::GetBucketById(const std::string& id)
         return Bucket();
     }
 
+    if (auto bucket = d_->cached(d_->bucketsById, id)) {
+        return std::move(*bucket);
+    }
+
     auto response = d_->client.Get("/api/v2/buckets/" + id);
     auto data = nlohmann::json::parse(response.body);
 
-    return Bucket(
-        data["id"],
-        data["name"],
-        data["orgID"],
-        transport::HttpClient(d_->client)
-    );
+    return d_->makeBucket(data);
 }
 
 Bucket Influx::GetBucketByName(const std::string& name)
@@ -95,17 +250,15 @@ Bucket Influx::GetBucketByName(const std::string& name)
         return Bucket();
     }
 
+    if (auto bucket = d_->cached(d_->bucketsByName, name)) {
+        return std::move(*bucket);
+    }
+
     auto response = d_->client.Get("/api/v2/buckets?name=" + name);
     auto data = nlohmann::json::parse(response.body);
 
     if (data.count("buckets") && data["buckets"].is_array() && data["buckets"].size() >= 1) {
-        const auto& subdata = data["buckets"][0];
-        return Bucket(
-            subdata["id"],
-            subdata["name"],
-            subdata["orgID"],
-            transport::HttpClient(d_->client)
-        );
+        return d_->makeBucket(data["buckets"][0]);
     }
 
     return Bucket();
@@ -124,17 +277,26 @@ std::vector<Bucket> Influx::ListBuckets(std::size_t limit, std::size_t offset)
 
     std::vector<Bucket> result;
     for (const auto& bucket: data["buckets"]) {
-        result.push_back(Bucket(
-            bucket["id"],
-            bucket["name"],
-            bucket["orgID"],
-            transport::HttpClient(d_->client)
-        ));
+        result.push_back(d_->makeBucket(bucket));
     }
 
     return result;
 }
 
+BucketRange Influx::Buckets(std::size_t pageSize)
+{
+    return BucketRange(transport::HttpClient(d_->client), pageSize);
+}
+
+Bucket Influx::GetBucket(const BucketInfo& info)
+{
+    if (info.id.empty()) {
+        return Bucket();
+    }
+
+    return d_->makeBucket(info.id, info.name, info.orgId);
+}
+
 void Influx::DeleteBucket(Bucket& bucket)
 {
     if (!bucket) {
@@ -142,36 +304,277 @@ void Influx::DeleteBucket(Bucket& bucket)
     }
 
     d_->client.Delete("/api/v2/buckets/" + bucket.id());
+    d_->uncache(bucket.id(), bucket.name());
+    d_->forget(bucket.id());
     bucket = Bucket();
 }
 
+void Influx::SetRequestOptions(const RequestOptions& options)
+{
+    d_->client.SetDefaultOptions(options);
+}
+
+const RequestOptions& Influx::requestOptions() const
+{
+    return d_->client.defaultOptions();
+}
+
+void Influx::SetResponseCompression(bool enabled)
+{
+    d_->client.SetResponseCompression(enabled);
+}
+
+bool Influx::responseCompression() const
+{
+    return d_->client.responseCompression();
+}
+
+void Influx::SetHttpVersion(transport::HttpVersion version)
+{
+    d_->client.SetHttpVersion(version);
+}
+
+transport::HttpVersion Influx::httpVersion() const
+{
+    return d_->client.httpVersion();
+}
+
+void Influx::SetBucketCacheTtl(const std::chrono::seconds& ttl)
+{
+    {
+        std::lock_guard<std::mutex> lock(d_->cacheMutex);
+        d_->cacheTtl = ttl;
+    }
+
+    if (ttl == 0s) {
+        d_->clearCache();
+    }
+}
+
+void Influx::InvalidateBucketCache()
+{
+    d_->clearCache();
+}
+
 std::string Influx::QueryRaw(const std::string& flux)
 {
-    nlohmann::json body = {
-        {"dialect", {
-            {"annotations", {"datatype"}},
-            {"dateTimeFormat", "RFC3339Nano"},
-            {"header", true}
-        }},
-        {"query", flux}
+    auto response = d_->client.Post(d_->query, QueryBody(flux));
+    return response.body;
+}
+
+std::vector<FluxTable> Influx::Query(const std::string& flux)
+{
+    FluxParser parser;
+    d_->client.Post(d_->query, QueryBody(flux), [&](std::string_view data) { parser.feed(data); });
+    return parser.finish();
+}
+
+std::string Influx::QueryRaw(const std::string& flux, const Timestamp& start, const Timestamp& stop)
+{
+    return QueryRaw(BindTimeRange(flux, start, stop));
+}
+
+std::vector<FluxTable> Influx::Query(const std::string& flux, const Timestamp& start, const Timestamp& stop)
+{
+    return Query(BindTimeRange(flux, start, stop));
+}
+
+std::vector<FluxTable> Influx::Query(const std::string& flux, const Timestamp& start, const Timestamp& stop, const ParallelQuery& options)
+{
+    struct SubRange {
+        Timestamp start;
+        Timestamp stop;
+        CancellationToken token;
+        std::size_t attempts = 0;
+        std::size_t failures = 0;
+        bool done = false;
+        std::vector<FluxTable> tables;
     };
 
-    auto response = d_->client.Post(
-        "/api/v2/query",
-        body.dump(),        
-        {
-            {"Content-Type", "application/json"},
-            {"Accept", "application/vnd.influx.arrow"}
+    if (stop <= start) {
+        throw InfluxError("Query range stop must be after its start");
+    }
+
+    // Each sub-range spans at least one clock tick
+    const auto length = static_cast<std::size_t>((stop - start).count());
+    const std::size_t splits = std::clamp<std::size_t>(options.splits, 1, length);
+    const auto step = (stop - start) / static_cast<Timestamp::rep>(splits);
+
+    std::vector<SubRange> ranges(splits);
+    for (std::size_t i = 0; i < splits; i++) {
+        ranges[i].start = start + step * static_cast<Timestamp::rep>(i);
+        ranges[i].stop = i + 1 == splits ? stop : ranges[i].start + step;
+    }
+
+    // Workers do not see the caller's scope: they get its limits, and its
+    // cancellation is forwarded to theirs
+    const RequestOptions* scope = RequestScope::Current();
+    const RequestOptions callerOptions = scope ? *scope : RequestOptions{};
+
+    std::mutex mutex;
+    std::condition_variable answered;
+    std::size_t completed = 0;
+    std::exception_ptr error;
+    std::vector<std::thread> workers;
+
+    auto issue = [&](SubRange& range) {
+        range.attempts++;
+        workers.emplace_back([&, &range = range, client = transport::HttpClient(d_->client)]() mutable {
+            RequestOptions attemptOptions = callerOptions;
+            attemptOptions.cancellation = range.token;
+            RequestScope attemptScope(attemptOptions);
+
+            std::vector<FluxTable> tables;
+            std::exception_ptr failure;
+            try {
+                FluxParser parser;
+                client.Post(d_->query, QueryBody(BindTimeRange(flux, range.start, range.stop)), [&](std::string_view data) { parser.feed(data); });
+                tables = parser.finish();
+            } catch (...) {
+                failure = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (range.done) {
+                return;
+            }
+
+            if (!failure) {
+                range.done = true;
+                range.tables = std::move(tables);
+                range.token.Cancel();  // the hedged twin, if any
+                completed++;
+            } else if (++range.failures == range.attempts && !error) {
+                error = failure;
+            }
+            answered.notify_all();
+        });
+    };
+
+    const std::size_t hedgeAfter = options.hedgeQuantile > 0
+        ? static_cast<std::size_t>(std::ceil(std::min(options.hedgeQuantile, 1.0) * static_cast<double>(splits)))
+        : 0;
+
+    {
+        // Released before the workers are joined
+        auto joinWorkers = finally([&]() {
+            for (auto& range: ranges) {
+                range.token.Cancel();
+            }
+            for (auto& worker: workers) {
+                worker.join();
+            }
+        });
+        std::unique_lock<std::mutex> lock(mutex);
+
+        for (auto& range: ranges) {
+            issue(range);
         }
-    );
 
-    return response.body;
+        while (completed < splits && !error) {
+            if (callerOptions.cancellation) {
+                answered.wait_for(lock, 50ms);
+                if (callerOptions.cancellation->cancelled()) {
+                    error = std::make_exception_ptr(CancelledError());
+                }
+            } else {
+                answered.wait(lock);
+            }
+
+            if (hedgeAfter && completed >= hedgeAfter && !error) {
+                for (auto& range: ranges) {
+                    if (!range.done && range.attempts == 1) {
+                        issue(range);
+                    }
+                }
+            }
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    std::vector<FluxTable> merged;
+    std::unordered_map<std::string, std::size_t> series;
+    for (auto& range: ranges) {
+        for (auto& table: range.tables) {
+            if (table.empty()) {
+                continue;
+            }
+
+            for (auto& record: table) {
+                if (record.start == range.start) record.start = start;
+                if (record.stop == range.stop) record.stop = stop;
+            }
+
+            auto [it, inserted] = series.try_emplace(SeriesKey(table), merged.size());
+            if (inserted) {
+                merged.push_back(std::move(table));
+            } else {
+                auto& target = merged[it->second];
+                target.insert(target.end(), std::make_move_iterator(table.begin()), std::make_move_iterator(table.end()));
+            }
+        }
+    }
+
+    return merged;
 }
 
-std::vector<FluxTable> Influx::Query(const std::string& flux)
+Task<std::string> Influx::QueryRawAsync(std::string flux)
+{
+    std::vector<std::string> body;
+    body.push_back(QueryBody(flux));
+
+    auto response = co_await d_->client.PostAsync(d_->query, std::move(body));
+
+    co_return std::move(response.body);
+}
+
+Task<std::vector<FluxTable>> Influx::QueryAsync(std::string flux)
 {
-    auto response = QueryRaw(flux);
-    return FluxParser().parse(response);
+    auto response = co_await QueryRawAsync(std::move(flux));
+    co_return FluxParser().parse(response);
+}
+
+void Influx::Export(const std::string& flux, const transport::BodySink& sink, ExportFormat format)
+{
+    if (format == ExportFormat::AnnotatedCsv) {
+        d_->client.Post(d_->query, QueryBody(flux), sink);
+        return;
+    }
+
+    CsvToLineProtocol converter(sink);
+    d_->client.Post(d_->query, QueryBody(flux), [&](std::string_view data) { converter.feed(data); });
+    converter.finish();
+}
+
+void Influx::Export(const std::string& flux, std::ostream& out, ExportFormat format)
+{
+    Export(flux, [&](std::string_view data) {
+        if (!out.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+            throw InfluxError("Cannot write query export");
+        }
+    }, format);
+}
+
+void Influx::Export(const std::string& flux, int fd, ExportFormat format)
+{
+    Export(flux, [&](std::string_view data) {
+        while (!data.empty()) {
+#if defined(_WIN32)
+            const int written = _write(fd, data.data(), static_cast<unsigned>(std::min<std::size_t>(data.size(), INT_MAX)));
+#else
+            const ssize_t written = write(fd, data.data(), data.size());
+#endif
+            if (written < 0 && errno == EINTR) {
+                continue;
+            } else if (written < 0) {
+                throw InfluxError("Cannot write query export");
+            }
+            data.remove_prefix(static_cast<std::size_t>(written));
+        }
+    }, format);
 }
 
 Bucket Influx::operator[](const std::string& name)
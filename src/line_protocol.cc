@@ -0,0 +1,123 @@
+#include <charconv>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "line_protocol.hh"
+
+namespace influx::lp {
+
+namespace {
+    template <typename T>
+    void AppendNumber(std::string& out, T value)
+    {
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    void AppendDouble(std::string& out, double value)
+    {
+#if defined(__cpp_lib_to_chars)
+        AppendNumber(out, value);
+#else
+        // No floating-point to_chars (libstdc++ < 11): use the shortest %g
+        // precision that reads back to the same value
+        char buffer[32];
+        for (int precision = 15; precision <= 17; precision++) {
+            std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+            if (std::strtod(buffer, nullptr) == value) {
+                break;
+            }
+        }
+        out.append(buffer);
+#endif
+    }
+
+    struct FieldValueAppender {
+        std::string& out;
+
+        void operator()(double value)             { AppendDouble(out, value); }
+        void operator()(std::int64_t value)       { AppendNumber(out, value); out.push_back('i'); }
+        void operator()(std::uint64_t value)      { AppendNumber(out, value); out.push_back('u'); }
+        void operator()(std::string_view value)   { out.push_back('"'); AppendEscaped(out, value, "\"\\"); out.push_back('"'); }
+        void operator()(bool value)               { out.append(value ? "true" : "false"); }
+    };
+}
+
+void AppendEscaped(std::string& out, std::string_view str, const char* chars)
+{
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < str.length(); ++i) {
+        // strchr finds the terminator of chars too
+        if (str[i] != '\0' && std::strchr(chars, str[i]) != nullptr) {
+            out.append(str.data() + start, i - start);
+            out.push_back('\\');
+            start = i;
+        }
+    }
+    out.append(str.data() + start, str.length() - start);
+}
+
+void AppendFieldValue(std::string& out, const FieldValue& value)
+{
+    std::visit(FieldValueAppender{out}, value);
+}
+
+void AppendFieldValue(std::string& out, const FieldValueView& value)
+{
+    std::visit(FieldValueAppender{out}, value);
+}
+
+void AppendTimestamp(std::string& out, const Timestamp& timestamp)
+{
+    AppendNumber(out, std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count());
+}
+
+namespace {
+    /* Measurement and PointView alike, empty being the error when there is
+     * no field */
+    template <typename Point>
+    void AppendPoint(std::string& out, const Point& point, const char* empty)
+    {
+        if (point.fields().empty()) {
+            throw InvalidMeasurementError(empty);
+        }
+
+        AppendEscaped(out, point.name(), " ,");
+
+        for (const auto& tag: point.tags()) {
+            out.push_back(',');
+            AppendEscaped(out, tag.key, " =,");
+            out.push_back('=');
+            AppendEscaped(out, tag.value, " =,");
+        }
+
+        bool first = true;
+        for (const auto& field: point.fields()) {
+            out.push_back(first ? ' ' : ',');
+            AppendEscaped(out, field.key, " =,");
+            out.push_back('=');
+            AppendFieldValue(out, field.value);
+            first = false;
+        }
+
+        if (point.timestamp() != NoTimestamp) {
+            out.push_back(' ');
+            AppendTimestamp(out, point.timestamp());
+        }
+    }
+}
+
+void Append(std::string& out, const Measurement& measurement)
+{
+    AppendPoint(out, measurement, "Cannot serialize empty Measurement");
+}
+
+void Append(std::string& out, const PointView& point)
+{
+    AppendPoint(out, point, "Cannot serialize empty PointView");
+}
+
+} // namespace
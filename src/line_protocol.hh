@@ -0,0 +1,27 @@
+#ifndef INFLUX__LINE_PROTOCOL_HH_
+#define INFLUX__LINE_PROTOCOL_HH_
+
+#include <string>
+#include <string_view>
+
+#include <influx/measurement.hh>
+#include <influx/point_view.hh>
+
+namespace influx::lp {
+
+/* Append characters of str to out, backslash-escaping any found in chars */
+void AppendEscaped(std::string& out, std::string_view str, const char* chars);
+
+void AppendFieldValue(std::string& out, const FieldValue& value);
+void AppendFieldValue(std::string& out, const FieldValueView& value);
+void AppendTimestamp(std::string& out, const Timestamp& timestamp);
+
+/* Append measurement or point to out in line protocol format precision=ns,
+ * without a trailing newline. The timestamp is omitted if it is NoTimestamp.
+ * Throws InvalidMeasurementError if it has no fields. */
+void Append(std::string& out, const Measurement& measurement);
+void Append(std::string& out, const PointView& point);
+
+} // namespace
+
+#endif
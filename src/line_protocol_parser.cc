@@ -0,0 +1,350 @@
+#include <charconv>
+#include <limits>
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include <influx/line_protocol_parser.hh>
+#include <influx/measurement.hh>
+
+namespace influx {
+
+namespace {
+    // Malformed line, reported with its number by Next
+    struct SyntaxError {
+        const char* message;
+    };
+
+    // Position of the first character from pos that is one of Stops and not
+    // backslash-escaped, or the end of line. Sets escaped if a backslash was
+    // skipped on the way.
+    template <char... Stops>
+    std::size_t Scan(std::string_view line, std::size_t pos, bool& escaped)
+    {
+        for (; pos < line.size(); pos++) {
+            const char c = line[pos];
+            if (c == '\\' && pos + 1 < line.size()) {
+                escaped = true;
+                pos++;
+            } else if (((c == Stops) || ...)) {
+                break;
+            }
+        }
+        return pos;
+    }
+
+    std::size_t SkipSpaces(std::string_view line, std::size_t pos)
+    {
+        while (pos < line.size() && line[pos] == ' ') {
+            pos++;
+        }
+        return pos;
+    }
+
+    // Digits only, checked for overflow. Much faster than from_chars on the
+    // long timestamps every line ends with.
+    bool ParseDigits(std::string_view token, std::uint64_t limit, std::uint64_t& value)
+    {
+        if (token.empty() || token.size() > 20) {
+            return false;
+        }
+
+        value = 0;
+        for (char c: token) {
+            const unsigned digit = static_cast<unsigned char>(c) - '0';
+            if (digit > 9 || value > (limit - digit) / 10) {
+                return false;
+            }
+            value = value * 10 + digit;
+        }
+        return true;
+    }
+
+    bool ParseNumber(std::string_view token, std::uint64_t& value)
+    {
+        return ParseDigits(token, std::numeric_limits<std::uint64_t>::max(), value);
+    }
+
+    bool ParseNumber(std::string_view token, std::int64_t& value)
+    {
+        const bool negative = !token.empty() && token.front() == '-';
+        const std::uint64_t limit = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) + (negative ? 1 : 0);
+
+        std::uint64_t magnitude;
+        if (!ParseDigits(token.substr(negative ? 1 : 0), limit, magnitude)) {
+            return false;
+        }
+
+        value = negative ? static_cast<std::int64_t>(0 - magnitude) : static_cast<std::int64_t>(magnitude);
+        return true;
+    }
+
+    // Clinger's fast path: a decimal with at most 15 significant digits and no
+    // exponent is an exact integer over an exact power of ten, so a single
+    // division rounds correctly. Covers most metrics.
+    bool ParseDecimal(std::string_view token, double& value)
+    {
+        static const double POW10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+        };
+
+        const bool negative = !token.empty() && token.front() == '-';
+        std::size_t i = negative ? 1 : 0;
+
+        std::uint64_t mantissa = 0;
+        std::size_t digits = 0;
+        std::size_t decimals = 0;
+        bool point = false;
+
+        for (; i < token.size(); i++) {
+            const char c = token[i];
+            if (c == '.' && !point) {
+                point = true;
+            } else if (c >= '0' && c <= '9') {
+                mantissa = mantissa * 10 + static_cast<unsigned>(c - '0');
+                decimals += point;
+                if (++digits > 15) {
+                    return false;
+                }
+            } else {
+                return false;
+            }
+        }
+
+        if (digits == 0) {
+            return false;
+        }
+
+        value = static_cast<double>(mantissa) / POW10[decimals];
+        value = negative ? -value : value;
+        return true;
+    }
+
+    // Finite decimals only: no inf, nan or hexadecimal, which the parsers
+    // below would otherwise read
+    bool IsDecimal(std::string_view token)
+    {
+        const std::size_t sign = !token.empty() && token.front() == '-' ? 1 : 0;
+        if (token.size() == sign || !(std::isdigit(static_cast<unsigned char>(token[sign])) || token[sign] == '.')) {
+            return false;
+        }
+        return token.find_first_not_of("0123456789.eE+-", sign) == std::string_view::npos;
+    }
+
+    bool ParseNumber(std::string_view token, double& value)
+    {
+        if (ParseDecimal(token, value)) {
+            return true;
+        }
+        if (!IsDecimal(token)) {
+            return false;
+        }
+
+#if defined(__cpp_lib_to_chars)
+        const char* end = token.data() + token.size();
+        auto result = std::from_chars(token.data(), end, value);
+        return result.ec == std::errc() && result.ptr == end && std::isfinite(value);
+#else
+        // No floating-point from_chars (libstdc++ < 11)
+        char buffer[64];
+        if (token.empty() || token.size() >= sizeof(buffer)) {
+            return false;
+        }
+
+        std::memcpy(buffer, token.data(), token.size());
+        buffer[token.size()] = '\0';
+
+        char* end;
+        value = std::strtod(buffer, &end);
+        return end == buffer + token.size() && std::isfinite(value);
+#endif
+    }
+
+    FieldValueView ParseValue(std::string_view token)
+    {
+        if (token.empty()) {
+            throw SyntaxError{"missing field value"};
+        }
+
+        const std::string_view digits = token.substr(0, token.size() - 1);
+
+        if (token.back() == 'i') {
+            std::int64_t value;
+            if (!ParseNumber(digits, value)) {
+                throw SyntaxError{"invalid integer field value"};
+            }
+            return value;
+        } else if (token.back() == 'u') {
+            std::uint64_t value;
+            if (!ParseNumber(digits, value)) {
+                throw SyntaxError{"invalid unsigned integer field value"};
+            }
+            return value;
+        } else if (token == "t" || token == "T" || token == "true" || token == "True" || token == "TRUE") {
+            return true;
+        } else if (token == "f" || token == "F" || token == "false" || token == "False" || token == "FALSE") {
+            return false;
+        }
+
+        double value;
+        if (!ParseNumber(token, value)) {
+            throw SyntaxError{"invalid field value"};
+        }
+        return value;
+    }
+}
+
+struct LineProtocolParser::Priv {
+    std::string_view input;
+    std::size_t pos = 0;
+    std::size_t line = 0;
+
+    // Unescaped tokens of the current line. Reserved to the line's length
+    // beforehand so it never reallocates under the views handed out.
+    std::string scratch;
+    PointView point{std::string_view(), NoTimestamp};
+
+    std::string_view unescape(std::string_view token, bool escaped, const char* chars)
+    {
+        if (!escaped) {
+            return token;
+        }
+
+        const std::size_t start = scratch.size();
+        for (std::size_t i = 0; i < token.size(); i++) {
+            if (token[i] == '\\' && i + 1 < token.size() && token[i + 1] != '\0' && std::strchr(chars, token[i + 1])) {
+                i++;
+            }
+            scratch.push_back(token[i]);
+        }
+        return std::string_view(scratch).substr(start);
+    }
+
+    void parse(std::string_view line)
+    {
+        bool escaped = false;
+        std::size_t end = Scan<',', ' '>(line, 0, escaped);
+
+        if (end == 0) {
+            throw SyntaxError{"missing measurement"};
+        }
+        point.Reset(unescape(line.substr(0, end), escaped, ", "), NoTimestamp);
+
+        std::size_t pos = end;
+        while (pos < line.size() && line[pos] == ',') {
+            escaped = false;
+            end = Scan<'=', ',', ' '>(line, ++pos, escaped);
+            if (end == line.size() || line[end] != '=') {
+                throw SyntaxError{"missing tag value"};
+            }
+            std::string_view key = unescape(line.substr(pos, end - pos), escaped, ",= ");
+
+            escaped = false;
+            pos = end + 1;
+            end = Scan<',', ' '>(line, pos, escaped);
+            if (end == pos) {
+                throw SyntaxError{"missing tag value"};
+            }
+            point.AddTag({key, unescape(line.substr(pos, end - pos), escaped, ",= ")});
+            pos = end;
+        }
+
+        if (pos == line.size()) {
+            throw SyntaxError{"missing fields"};
+        }
+        pos = SkipSpaces(line, pos);
+
+        for (;;) {
+            escaped = false;
+            end = Scan<'=', ',', ' '>(line, pos, escaped);
+            if (end == line.size() || line[end] != '=') {
+                throw SyntaxError{"missing field value"};
+            }
+            std::string_view key = unescape(line.substr(pos, end - pos), escaped, ",= ");
+            pos = end + 1;
+
+            if (pos < line.size() && line[pos] == '"') {
+                escaped = false;
+                end = Scan<'"'>(line, ++pos, escaped);
+                if (end == line.size()) {
+                    throw SyntaxError{"unterminated string field value"};
+                }
+                point.AddField({key, unescape(line.substr(pos, end - pos), escaped, "\"\\")});
+                pos = end + 1;
+            } else {
+                end = std::min(line.find_first_of(", ", pos), line.size());
+                point.AddField({key, ParseValue(line.substr(pos, end - pos))});
+                pos = end;
+            }
+
+            if (pos == line.size() || line[pos] != ',') {
+                break;
+            }
+            pos++;
+        }
+
+        pos = SkipSpaces(line, pos);
+        if (pos < line.size()) {
+            std::int64_t ns;
+            if (!ParseNumber(line.substr(pos), ns)) {
+                throw SyntaxError{"invalid timestamp"};
+            }
+            point.SetTimestamp(Timestamp(std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(ns))));
+        }
+    }
+};
+
+LineProtocolParser::LineProtocolParser(std::string_view input)
+    : d_(new Priv{input})
+{
+}
+
+LineProtocolParser::LineProtocolParser(LineProtocolParser&& other) = default;
+LineProtocolParser& LineProtocolParser::operator=(LineProtocolParser&& other) = default;
+
+LineProtocolParser::~LineProtocolParser()
+{
+}
+
+PointView* LineProtocolParser::Next()
+{
+    while (d_->pos < d_->input.size()) {
+        const std::size_t end = std::min(d_->input.find('\n', d_->pos), d_->input.size());
+        std::string_view line = d_->input.substr(d_->pos, end - d_->pos);
+        d_->pos = end + 1;
+        d_->line++;
+
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        line.remove_prefix(std::min(line.find_first_not_of(" \t"), line.size()));
+
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+
+        d_->scratch.clear();
+        d_->scratch.reserve(line.size());
+
+        try {
+            d_->parse(line);
+        } catch (SyntaxError& e) {
+            throw LineProtocolError(d_->line, e.message);
+        } catch (InvalidMeasurementError& e) {
+            throw LineProtocolError(d_->line, e.what());
+        }
+
+        return &d_->point;
+    }
+
+    return nullptr;
+}
+
+std::size_t LineProtocolParser::line() const
+{
+    return d_->line;
+}
+
+} // namespace
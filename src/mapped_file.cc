@@ -0,0 +1,106 @@
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <influx/types.hh>
+
+#include "mapped_file.hh"
+#include "util.hh"
+
+namespace influx {
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string& path)
+{
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        file_ = nullptr;
+        throw InfluxError("Cannot open file");
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size)) {
+        CloseHandle(file_);
+        throw InfluxError("Cannot stat file");
+    }
+    size_ = static_cast<std::size_t>(size.QuadPart);
+
+    // Empty files cannot be mapped
+    if (size_ == 0) {
+        return;
+    }
+
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ != nullptr) {
+        data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    }
+
+    if (data_ == nullptr) {
+        if (mapping_ != nullptr) {
+            CloseHandle(mapping_);
+        }
+        CloseHandle(file_);
+        throw InfluxError("Cannot map file");
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_ != nullptr) {
+        CloseHandle(mapping_);
+    }
+    if (file_ != nullptr) {
+        CloseHandle(file_);
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw InfluxError("Cannot open file");
+    }
+    auto _ = finally([&]() { close(fd); });
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        throw InfluxError("Cannot stat file");
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+
+    // Empty files cannot be mapped
+    if (size_ == 0) {
+        return;
+    }
+
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        throw InfluxError("Cannot map file");
+    }
+
+    madvise(data, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(data);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+#endif
+
+} // namespace
@@ -0,0 +1,32 @@
+#ifndef INFLUX__MAPPED_FILE_HH_
+#define INFLUX__MAPPED_FILE_HH_
+
+#include <string>
+#include <string_view>
+
+namespace influx {
+
+/* Read-only memory mapping of a whole file, hinted for sequential access.
+ * Throws InfluxError if the file cannot be opened or mapped. */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    std::string_view data() const { return {data_, size_}; }
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+
+#if defined(_WIN32)
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+} // namespace
+
+#endif
@@ -1,72 +1,78 @@
-#include <iomanip>
+#include <algorithm>
 
 #include <influx/measurement.hh>
 
+#include "line_protocol.hh"
+
+namespace influx {
+
 namespace {
-    bool Contains(char needle, const char* haystack)
+    void CheckTagKey(std::string_view key)
     {
-        const char* current = haystack;
-        while (*current != '\0') {
-            if (needle == *current) {
-                return true;
-            }
-            current++;
+        if (key.length() == 0) {
+            throw InvalidMeasurementError("Tag keys cannot be empty");
         }
 
-        return false;
+        if (key[0] == '_') {
+            throw InvalidMeasurementError("Tag keys cannot being with '_'");
+        }
     }
 
-    std::string Escape(const std::string& str, const char* chars)
+    void CheckFieldKey(std::string_view key)
     {
-        std::string escaped;
-        escaped.reserve(str.length());
+        if (key.length() == 0) {
+            throw InvalidMeasurementError("Field keys cannot be empty");
+        }
 
-        for (size_t i = 0; i < str.length(); ++i) {
-            if (Contains(str[i], chars)) {
-                escaped.push_back('\\');
-            }
-            escaped.push_back(str[i]);
+        if (key[0] == '_') {
+            throw InvalidMeasurementError("Field keys cannot being with '_'");
         }
-        return escaped;
     }
 
-    struct FieldValuePrinter {
-        std::ostream& os;
+    /* Set the value of the element of set with key, reusing a spare node if
+     * there is none. Elements are extracted to be modified, and put back. */
+    template <typename Set, typename Assign>
+    void Upsert(Set& set, std::vector<typename Set::node_type>& spare, std::string_view key, const Assign& assign)
+    {
+        auto it = std::find_if(set.begin(), set.end(), [&](const auto& element) { return element.key == key; });
+
+        typename Set::node_type node;
+        if (it != set.end()) {
+            node = set.extract(it);
+        } else if (!spare.empty()) {
+            // Preferably the node that held key, its value likely fits
+            auto reused = std::find_if(spare.begin(), spare.end(), [&](const auto& node) { return node.value().key == key; });
+            if (reused == spare.end()) {
+                reused = spare.end() - 1;
+            }
+            node = std::move(*reused);
+            *reused = std::move(spare.back());
+            spare.pop_back();
+            node.value().key.assign(key);
+        } else {
+            typename Set::value_type element(std::string(key), {});
+            assign(element);
+            set.insert(std::move(element));
+            return;
+        }
 
-        void operator()(double value)             { os << value; }
-        void operator()(std::int64_t value)       { os << value << "i"; }
-        void operator()(std::uint64_t value)      { os << value << "u"; }
-        void operator()(const std::string& value) { os << "\"" << Escape(value, "\"\\") << "\""; }
-        void operator()(bool value)               { os << (value ? "true" : "false"); }
-    };
+        assign(node.value());
+        set.insert(std::move(node));
+    }
 }
 
-namespace influx {
-
 Tag::Tag(const std::string& key, const std::string& value)
     : key(key)
     , value(value)
 {
-    if (key.length() == 0) {
-        throw InvalidMeasurementError("Tag keys cannot be empty");
-    }
-
-    if (key[0] == '_') {
-        throw InvalidMeasurementError("Tag keys cannot being with '_'");
-    }
+    CheckTagKey(key);
 }
 
 Field::Field(const std::string& key, const FieldValue& value)
     : key(key)
     , value(value)
 {
-    if (key.length() == 0) {
-        throw InvalidMeasurementError("Field keys cannot be empty");
-    }
-
-    if (key[0] == '_') {
-        throw InvalidMeasurementError("Field keys cannot being with '_'");
-    }
+    CheckFieldKey(key);
 }
 
 bool operator==(const Tag& lhs, const Tag& rhs)
@@ -113,6 +119,25 @@ Measurement::Measurement(const std::string& name, const std::set<Tag>& tags, con
 {
 }
 
+Measurement::Measurement(const PointView& point)
+    : name_(point.name())
+    , timestamp_(point.timestamp())
+{
+    for (const TagView& tag: point.tags()) {
+        tags_.emplace(std::string(tag.key), std::string(tag.value));
+    }
+
+    for (const FieldView& field: point.fields()) {
+        fields_.emplace(std::string(field.key), std::visit([](const auto& value) -> FieldValue {
+            if constexpr (std::is_same_v<std::decay_t<decltype(value)>, std::string_view>) {
+                return std::string(value);
+            } else {
+                return value;
+            }
+        }, field.value));
+    }
+}
+
 bool Measurement::operator==(const Measurement& other) const
 {
     return name_ == other.name_ 
@@ -141,7 +166,44 @@ bool Measurement::operator!=(const Measurement& other) const
      timestamp_ = timestamp;
  }
 
-std::string Measurement::name() const
+void Measurement::Reset(std::string_view name, Timestamp timestamp)
+{
+    name_.assign(name);
+    timestamp_ = timestamp;
+
+    while (!tags_.empty()) {
+        spare_.tags.push_back(tags_.extract(tags_.begin()));
+    }
+    while (!fields_.empty()) {
+        spare_.fields.push_back(fields_.extract(fields_.begin()));
+    }
+}
+
+void Measurement::SetTag(std::string_view key, std::string_view value)
+{
+    CheckTagKey(key);
+    Upsert(tags_, spare_.tags, key, [&](Tag& tag) { tag.value.assign(value); });
+}
+
+void Measurement::SetField(std::string_view key, const FieldValue& value)
+{
+    CheckFieldKey(key);
+    Upsert(fields_, spare_.fields, key, [&](Field& field) { field.value = value; });
+}
+
+void Measurement::SetField(std::string_view key, std::string_view value)
+{
+    CheckFieldKey(key);
+    Upsert(fields_, spare_.fields, key, [&](Field& field) {
+        if (auto* string = std::get_if<std::string>(&field.value)) {
+            string->assign(value);
+        } else {
+            field.value.emplace<std::string>(value);
+        }
+    });
+}
+
+const std::string& Measurement::name() const
 {
     return name_;
 } 
@@ -163,27 +225,9 @@ Timestamp Measurement::timestamp() const
 
 std::ostream& operator<<(std::ostream& os, const influx::Measurement& measurement)
 {
-    if (measurement.fields().empty()) {
-        throw influx::InvalidMeasurementError("Cannot serialize empty Measurement");
-    }
-
-    os << Escape(measurement.name(), " ,");
-
-    for (const influx::Tag& tag: measurement.tags()) {
-        os << "," << Escape(tag.key, " =,") << "=" << Escape(tag.value, " =,");
-    }
-
-    bool first = true;
-    FieldValuePrinter printer{os};
-    for (const influx::Field& field: measurement.fields()) {
-        os << (first ? " " : ",");
-        os << Escape(field.key, " =,") << "=";
-        std::visit(printer, field.value);
-        first = false;
-    }
-
-    os << " " << std::chrono::duration_cast<std::chrono::nanoseconds>(measurement.timestamp().time_since_epoch()).count();
-    return os;
+    std::string line;
+    lp::Append(line, measurement);
+    return os << line;
 }
 
 } // namespace
@@ -0,0 +1,99 @@
+#include <influx/measurement.hh>
+#include <influx/point_view.hh>
+
+namespace influx {
+
+namespace {
+    void CheckKey(std::string_view key, const char* empty, const char* reserved)
+    {
+        if (key.empty()) {
+            throw InvalidMeasurementError(empty);
+        }
+
+        if (key[0] == '_') {
+            throw InvalidMeasurementError(reserved);
+        }
+    }
+
+    /* Appends to inline until it is full, then moves everything to more */
+    template <typename T, std::size_t N>
+    void Append(std::array<T, N>& inline_, std::vector<T>& more, std::size_t& count, const T& value)
+    {
+        if (count < N) {
+            inline_[count++] = value;
+            return;
+        }
+
+        if (count == N) {
+            more.assign(inline_.begin(), inline_.end());
+        }
+        more.push_back(value);
+        count++;
+    }
+}
+
+PointView::PointView(std::string_view name, Timestamp timestamp)
+    : name_(name)
+    , timestamp_(timestamp)
+{
+}
+
+void PointView::Reset(std::string_view name, Timestamp timestamp)
+{
+    name_ = name;
+    timestamp_ = timestamp;
+    tagCount_ = 0;
+    fieldCount_ = 0;
+}
+
+void PointView::AddTag(const TagView& tag)
+{
+    CheckKey(tag.key, "Tag keys cannot be empty", "Tag keys cannot being with '_'");
+    Append(tags_, moreTags_, tagCount_, tag);
+}
+
+void PointView::AddField(const FieldView& field)
+{
+    CheckKey(field.key, "Field keys cannot be empty", "Field keys cannot being with '_'");
+    Append(fields_, moreFields_, fieldCount_, field);
+}
+
+void PointView::SetTimestamp(const Timestamp& timestamp)
+{
+    timestamp_ = timestamp;
+}
+
+} // namespace
+
+influx::PointView& operator<<(influx::PointView& point, const influx::TagView& tag)
+{
+    point.AddTag(tag);
+    return point;
+}
+
+influx::PointView& operator<<(influx::PointView& point, const influx::FieldView& field)
+{
+    point.AddField(field);
+    return point;
+}
+
+influx::PointView& operator<<(influx::PointView& point, const influx::Timestamp& timestamp)
+{
+    point.SetTimestamp(timestamp);
+    return point;
+}
+
+influx::PointView&& operator<<(influx::PointView&& point, const influx::TagView& tag)
+{
+    return std::move(point << tag);
+}
+
+influx::PointView&& operator<<(influx::PointView&& point, const influx::FieldView& field)
+{
+    return std::move(point << field);
+}
+
+influx::PointView&& operator<<(influx::PointView&& point, const influx::Timestamp& timestamp)
+{
+    return std::move(point << timestamp);
+}
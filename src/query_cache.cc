@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include <influx/query_cache.hh>
+
+namespace influx {
+
+namespace {
+    struct Entry {
+        Timestamp start;
+        Timestamp stop;
+        std::vector<FluxTable> tables;
+    };
+
+    bool SameGroup(const FluxRecord& lhs, const FluxRecord& rhs)
+    {
+        return lhs.name == rhs.name
+            && lhs.measurement == rhs.measurement
+            && lhs.field == rhs.field
+            && lhs.tags == rhs.tags;
+    }
+
+    void Append(std::vector<FluxTable>& tables, std::vector<FluxTable>&& tail)
+    {
+        for (FluxTable& table: tail) {
+            if (table.empty()) {
+                continue;
+            }
+
+            auto it = std::find_if(tables.begin(), tables.end(), [&](const FluxTable& cached) {
+                return !cached.empty() && SameGroup(cached.front(), table.front());
+            });
+
+            if (it == tables.end()) {
+                tables.emplace_back(std::move(table));
+            } else {
+                std::move(table.begin(), table.end(), std::back_inserter(*it));
+            }
+        }
+    }
+
+    void Slide(std::vector<FluxTable>& tables, const Timestamp& start, const Timestamp& stop)
+    {
+        for (FluxTable& table: tables) {
+            std::erase_if(table, [&](const FluxRecord& record) { return record.time < start; });
+
+            for (FluxRecord& record: table) {
+                record.start = start;
+                record.stop = stop;
+            }
+        }
+
+        std::erase_if(tables, [](const FluxTable& table) { return table.empty(); });
+    }
+}
+
+struct QueryCache::Priv {
+    Influx influx;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+};
+
+QueryCache::QueryCache(const Influx& influx)
+    : d_(new Priv{influx})
+{
+}
+
+QueryCache::QueryCache(QueryCache&& other) = default;
+QueryCache& QueryCache::operator=(QueryCache&& other) = default;
+
+QueryCache::~QueryCache()
+{
+}
+
+std::vector<FluxTable> QueryCache::Query(const std::string& flux, const std::chrono::nanoseconds& window)
+{
+    const Timestamp stop = Clock::now();
+    return Query(flux, stop - std::chrono::duration_cast<Clock::duration>(window), stop);
+}
+
+std::vector<FluxTable> QueryCache::Query(const std::string& flux, const Timestamp& start, const Timestamp& stop)
+{
+    if (stop <= start) {
+        throw InfluxError("Query range stop must be after its start");
+    }
+
+    const std::string key = std::to_string((stop - start).count()) + "\n" + flux;
+
+    // Queries run unlocked, so that other windows are served meanwhile
+    std::optional<Timestamp> cachedStop;
+    {
+        std::lock_guard<std::mutex> lock(d_->mutex);
+        auto it = d_->entries.find(key);
+
+        // Anything but a window sliding forward over the cached one is a miss
+        if (it != d_->entries.end() && start >= it->second.start && start <= it->second.stop && stop >= it->second.stop) {
+            cachedStop = it->second.stop;
+        }
+    }
+
+    if (cachedStop) {
+        std::vector<FluxTable> tail;
+        if (stop > *cachedStop) {
+            tail = d_->influx.Query(flux, *cachedStop, stop);
+        }
+
+        std::lock_guard<std::mutex> lock(d_->mutex);
+        auto it = d_->entries.find(key);
+
+        // Unless a concurrent query moved the entry meanwhile
+        if (it != d_->entries.end() && it->second.stop == *cachedStop && it->second.start <= start) {
+            Entry& entry = it->second;
+            Append(entry.tables, std::move(tail));
+            Slide(entry.tables, start, stop);
+            entry.start = start;
+            entry.stop = stop;
+            return entry.tables;
+        }
+    }
+
+    std::vector<FluxTable> tables = d_->influx.Query(flux, start, stop);
+
+    std::lock_guard<std::mutex> lock(d_->mutex);
+    auto it = d_->entries.find(key);
+
+    // A later window cached meanwhile is kept
+    if (it == d_->entries.end() || it->second.stop <= stop) {
+        d_->entries.insert_or_assign(key, Entry{start, stop, tables});
+    }
+    return tables;
+}
+
+void QueryCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(d_->mutex);
+    d_->entries.clear();
+}
+
+std::size_t QueryCache::size() const
+{
+    std::lock_guard<std::mutex> lock(d_->mutex);
+    return d_->entries.size();
+}
+
+} // namespace
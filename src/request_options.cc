@@ -0,0 +1,27 @@
+#include <utility>
+
+#include <influx/request_options.hh>
+
+namespace influx {
+
+namespace {
+    thread_local const RequestOptions* currentScope = nullptr;
+}
+
+RequestScope::RequestScope(const RequestOptions& options)
+    : options_(options)
+    , previous_(std::exchange(currentScope, &options_))
+{
+}
+
+RequestScope::~RequestScope()
+{
+    currentScope = previous_;
+}
+
+const RequestOptions* RequestScope::Current()
+{
+    return currentScope;
+}
+
+} // namespace
@@ -0,0 +1,121 @@
+#include <cstdint>
+#include <cstdio>
+
+#include "rfc3339.hh"
+
+namespace influx {
+
+namespace {
+    // days_from_civil from Howard Hinnant's date algorithms, as <chrono>
+    // calendar types are not available on every supported compiler
+    std::int64_t DaysFromCivil(std::int64_t year, std::int64_t month, std::int64_t day)
+    {
+        year -= month <= 2;
+        const std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+        const std::int64_t yoe = year - era * 400;
+        const std::int64_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+        const std::int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468;
+    }
+
+    bool IsDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    std::int64_t Digits(std::string_view str, std::size_t pos, std::size_t count)
+    {
+        std::int64_t value = 0;
+        for (std::size_t i = pos; i < pos + count; i++) {
+            if (i >= str.size() || !IsDigit(str[i])) {
+                throw InfluxError("Invalid RFC3339 timestamp");
+            }
+            value = value * 10 + (str[i] - '0');
+        }
+        return value;
+    }
+}
+
+std::string FormatRFC3339(const Timestamp& timestamp)
+{
+    const std::int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+    const std::int64_t seconds = ns / 1000000000 - (ns % 1000000000 < 0);
+    const std::int64_t z = seconds / 86400 - (seconds % 86400 < 0);
+    const std::int64_t sod = seconds - z * 86400;
+
+    // civil_from_days, counterpart of DaysFromCivil
+    const std::int64_t shifted = z + 719468;
+    const std::int64_t era = (shifted >= 0 ? shifted : shifted - 146096) / 146097;
+    const std::int64_t doe = shifted - era * 146097;
+    const std::int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const std::int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const std::int64_t mp = (5 * doy + 2) / 153;
+    const std::int64_t day = doy - (153 * mp + 2) / 5 + 1;
+    const std::int64_t month = mp < 10 ? mp + 3 : mp - 9;
+    const std::int64_t year = yoe + era * 400 + (month <= 2);
+
+    char buffer[160];
+    std::snprintf(buffer, sizeof(buffer), "%04lld-%02lld-%02lldT%02lld:%02lld:%02lld.%09lldZ",
+        static_cast<long long>(year),
+        static_cast<long long>(month),
+        static_cast<long long>(day),
+        static_cast<long long>(sod / 3600),
+        static_cast<long long>(sod / 60 % 60),
+        static_cast<long long>(sod % 60),
+        static_cast<long long>(ns - seconds * 1000000000)
+    );
+    return buffer;
+}
+
+Timestamp ParseRFC3339(std::string_view str)
+{
+    if (str.size() < 20 || str[4] != '-' || str[7] != '-' || (str[10] != 'T' && str[10] != 't') || str[13] != ':' || str[16] != ':') {
+        throw InfluxError("Invalid RFC3339 timestamp");
+    }
+
+    const std::int64_t year = Digits(str, 0, 4);
+    const std::int64_t month = Digits(str, 5, 2);
+    const std::int64_t day = Digits(str, 8, 2);
+    const std::int64_t hour = Digits(str, 11, 2);
+    const std::int64_t minute = Digits(str, 14, 2);
+    const std::int64_t second = Digits(str, 17, 2);
+
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        throw InfluxError("Invalid RFC3339 timestamp");
+    }
+
+    // Fraction, truncated to nanoseconds
+    std::size_t pos = 19;
+    std::int64_t ns = 0;
+    if (str[pos] == '.') {
+        const std::size_t begin = ++pos;
+        for (; pos < str.size() && IsDigit(str[pos]); pos++) {
+            if (pos - begin < 9) {
+                ns = ns * 10 + (str[pos] - '0');
+            }
+        }
+        if (pos == begin) {
+            throw InfluxError("Invalid RFC3339 timestamp");
+        }
+        for (std::size_t digits = pos - begin; digits < 9; digits++) {
+            ns *= 10;
+        }
+    }
+
+    std::int64_t offset = 0;
+    if (pos < str.size() && (str[pos] == 'Z' || str[pos] == 'z')) {
+        pos++;
+    } else if (pos + 6 == str.size() && (str[pos] == '+' || str[pos] == '-') && str[pos + 3] == ':') {
+        offset = (Digits(str, pos + 1, 2) * 3600 + Digits(str, pos + 4, 2) * 60) * (str[pos] == '-' ? -1 : 1);
+        pos += 6;
+    }
+
+    if (pos != str.size()) {
+        throw InfluxError("Invalid RFC3339 timestamp");
+    }
+
+    const std::int64_t seconds = DaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offset;
+    return Timestamp(std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(seconds * 1000000000 + ns)));
+}
+
+} // namespace
@@ -0,0 +1,20 @@
+#ifndef INFLUX__RFC3339_HH_
+#define INFLUX__RFC3339_HH_
+
+#include <string>
+#include <string_view>
+
+#include <influx/types.hh>
+
+namespace influx {
+
+/* Format timestamp as UTC with nanoseconds, e.g. 2021-01-01T00:00:00.000000000Z */
+std::string FormatRFC3339(const Timestamp& timestamp);
+
+/* Parse an RFC3339 timestamp with optional fraction (up to nanoseconds) and
+ * either Z or a numeric offset. Throws InfluxError if malformed. */
+Timestamp ParseRFC3339(std::string_view str);
+
+} // namespace
+
+#endif
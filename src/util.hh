@@ -1,6 +1,9 @@
 #ifndef INFLUX__UTIL_HH_
 #define INFLUX__UTIL_HH_
 
+#include <type_traits>
+#include <utility>
+
 namespace influx {
 
 // final_action and finally() taken as-is from Microsoft's GSL library (MIT license)
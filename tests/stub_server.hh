@@ -0,0 +1,243 @@
+#ifndef INFLUX__TEST__STUB_SERVER_HH_
+#define INFLUX__TEST__STUB_SERVER_HH_
+
+// Sockets are POSIX only, tests using the stub are left out on Windows
+#if !defined(_WIN32)
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <cctype>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace influx::test {
+
+/* Minimal HTTP/1.1 server for transport tests, listening on loopback TCP or
+ * a Unix domain socket. Answers each request through a handler, on one thread
+ * per connection, and records the requests. */
+class StubServer {
+public:
+    struct Request {
+        std::string method;
+        std::string target;
+        std::unordered_map<std::string, std::string> headers;  // lowercase names
+        std::string body;
+    };
+
+    struct Response {
+        int status = 204;
+        std::string body;
+        std::string raw;  // sent as is instead, when set
+    };
+
+    using Handler = std::function<Response(const Request&)>;
+
+    /* Listen on 127.0.0.1 with an ephemeral port */
+    explicit StubServer(Handler handler = {})
+        : handler_(std::move(handler))
+        , fd_(socket(AF_INET, SOCK_STREAM, 0))
+    {
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(addr);
+
+        bind(fd_, reinterpret_cast<sockaddr*>(&addr), length);
+        getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &length);
+        host_ = "http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+        start();
+    }
+
+    /* Listen on a Unix domain socket at path */
+    StubServer(const std::string& path, Handler handler)
+        : handler_(std::move(handler))
+        , fd_(socket(AF_UNIX, SOCK_STREAM, 0))
+        , path_(path)
+    {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+        unlink(path.c_str());
+        bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        host_ = "unix://" + path;
+        start();
+    }
+
+    StubServer(const StubServer&) = delete;
+    StubServer& operator=(const StubServer&) = delete;
+
+    ~StubServer()
+    {
+        // Wakes up accept(), then every recv() in progress
+        shutdown(fd_, SHUT_RDWR);
+        acceptor_.join();
+
+        for (int connection: connections_) {
+            shutdown(connection, SHUT_RDWR);
+        }
+        for (auto& worker: workers_) {
+            worker.join();
+        }
+        for (int connection: connections_) {
+            close(connection);
+        }
+        close(fd_);
+
+        if (!path_.empty()) {
+            unlink(path_.c_str());
+        }
+    }
+
+    /* Host string to hand to an Influx or HttpClient */
+    const std::string& host() const { return host_; }
+
+    std::vector<Request> requests() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return requests_;
+    }
+
+    /* Number of connections accepted so far */
+    std::size_t connectionCount() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return connections_.size();
+    }
+
+private:
+    void start()
+    {
+        listen(fd_, 16);
+        acceptor_ = std::thread([this]() {
+            for (int connection; (connection = accept(fd_, nullptr, nullptr)) >= 0;) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                connections_.push_back(connection);
+                workers_.emplace_back([this, connection]() { serve(connection); });
+            }
+        });
+    }
+
+    void serve(int connection)
+    {
+        std::string buffer;
+        while (true) {
+            std::size_t end;
+            while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+                if (!receive(connection, buffer)) {
+                    return;
+                }
+            }
+
+            Request request = parseHead(buffer.substr(0, end));
+            buffer.erase(0, end + 4);
+
+            if (request.headers["expect"] == "100-continue") {
+                sendAll(connection, "HTTP/1.1 100 Continue\r\n\r\n");
+            }
+
+            const std::size_t length = std::stoul(request.headers.count("content-length") ? request.headers["content-length"] : "0");
+            while (buffer.size() < length) {
+                if (!receive(connection, buffer)) {
+                    return;
+                }
+            }
+            request.body = buffer.substr(0, length);
+            buffer.erase(0, length);
+
+            Response response = handler_ ? handler_(request) : Response{};
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                requests_.push_back(std::move(request));
+            }
+
+            if (!response.raw.empty()) {
+                sendAll(connection, response.raw);
+                continue;
+            }
+
+            sendAll(connection,
+                "HTTP/1.1 " + std::to_string(response.status) + " Stub\r\n"
+                "Content-Type: application/json\r\n"
+                "Content-Length: " + std::to_string(response.body.size()) + "\r\n\r\n" + response.body);
+        }
+    }
+
+    static bool receive(int connection, std::string& buffer)
+    {
+        char chunk[16384];
+        const ssize_t n = recv(connection, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+            return false;
+        }
+        buffer.append(chunk, static_cast<std::size_t>(n));
+        return true;
+    }
+
+    static void sendAll(int connection, const std::string& data)
+    {
+        for (std::size_t sent = 0; sent < data.size();) {
+            const ssize_t n = send(connection, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return;
+            }
+            sent += static_cast<std::size_t>(n);
+        }
+    }
+
+    static Request parseHead(const std::string& head)
+    {
+        Request request;
+        std::size_t pos = head.find("\r\n");
+        const std::string line = head.substr(0, pos);
+
+        const std::size_t space = line.find(' ');
+        request.method = line.substr(0, space);
+        request.target = line.substr(space + 1, line.rfind(' ') - space - 1);
+
+        while (pos != std::string::npos && pos < head.size()) {
+            const std::size_t begin = pos + 2;
+            pos = head.find("\r\n", begin);
+            const std::string header = head.substr(begin, pos == std::string::npos ? std::string::npos : pos - begin);
+
+            const std::size_t colon = header.find(':');
+            if (colon == std::string::npos) {
+                continue;
+            }
+
+            std::string name = header.substr(0, colon);
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            const std::size_t value = header.find_first_not_of(' ', colon + 1);
+            request.headers[name] = value == std::string::npos ? "" : header.substr(value);
+        }
+        return request;
+    }
+
+    Handler handler_;
+    int fd_;
+    std::string path_;
+    std::string host_;
+
+    mutable std::mutex mutex_;
+    std::vector<Request> requests_;
+    std::vector<int> connections_;
+    std::thread acceptor_;
+    std::vector<std::thread> workers_;
+};
+
+} // namespace
+
+#endif
+
+#endif
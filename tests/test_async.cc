@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include "config.hh"
+
+#include <influx/async.hh>
+#include <influx/influx.hh>
+
+using namespace std::chrono_literals;
+
+namespace {
+    influx::Task<int> answer()
+    {
+        co_return 42;
+    }
+
+    influx::Task<int> twice()
+    {
+        int value = co_await answer();
+        co_return value * 2;
+    }
+
+    influx::Task<void> fail()
+    {
+        throw influx::InfluxError("failed");
+        co_return;
+    }
+}
+
+TEST(EventLoopTest, should_run_tasks_to_completion)
+{
+    influx::EventLoop loop;
+    EXPECT_EQ(loop.Run(answer()), 42);
+    EXPECT_EQ(loop.Run(twice()), 84);
+    EXPECT_EQ(influx::EventLoop::Current(), nullptr);
+}
+
+TEST(EventLoopTest, should_rethrow_task_exceptions)
+{
+    influx::EventLoop loop;
+
+    try {
+        loop.Run(fail());
+        EXPECT_TRUE(false);
+    } catch (influx::InfluxError& e) {
+        EXPECT_STREQ(e.what(), "failed");
+    }
+}
+
+TEST(EventLoopTest, should_refuse_requests_outside_of_loop)
+{
+    influx::transport::HttpClient client("http://localhost:1", "org", "token");
+
+    // Resumed by hand, with no EventLoop running
+    auto task = [](influx::transport::HttpClient& client) -> influx::Task<void> {
+        co_await client.GetAsync("/");
+    };
+
+    try {
+        auto request = task(client);
+        request.await_suspend(std::noop_coroutine()).resume();
+        request.await_resume();
+        EXPECT_TRUE(false);
+    } catch (influx::InfluxError& e) {
+        EXPECT_STREQ(e.what(), "Asynchronous requests must be awaited from a running EventLoop");
+    }
+}
+
+class AsyncTest: public ::testing::Test {
+protected:
+    influx::Influx db = influx::test::db();
+    std::string name = influx::test::nowstring();
+    influx::Bucket bucket = db.CreateBucket(name, 1h);
+
+    void TearDown() override
+    {
+        auto buckets = db.ListBuckets();
+        for (auto& bucket: buckets) {
+            if (!bucket.is_system_bucket()) {
+                db.DeleteBucket(bucket);
+            }
+        }
+    }
+};
+
+TEST_F(AsyncTest, should_flush_and_query_concurrently)
+{
+    influx::EventLoop loop;
+    auto now = influx::Clock::now() - 1s;
+
+    std::vector<influx::Bucket> buckets;
+    buckets.reserve(16);
+    for (int i = 0; i < 16; i++) {
+        buckets.push_back(db[name]);
+        buckets.back() << (influx::Measurement("m", now + i * 1ms) << influx::Field("x", i) << influx::Tag("writer", std::to_string(i)));
+    }
+
+    for (auto& bucket: buckets) {
+        loop.Spawn(bucket.FlushAsync());
+    }
+    loop.Run();
+
+    for (auto& bucket: buckets) {
+        EXPECT_EQ(bucket.BufferedMeasurementsCount(), 0);
+    }
+
+    std::vector<std::size_t> counts(8);
+    for (auto& count: counts) {
+        loop.Spawn([](influx::Influx& db, std::string name, std::size_t& count) -> influx::Task<void> {
+            auto tables = co_await db.QueryAsync(R"~(
+                from(bucket: ")~" + name + R"~(")
+                    |> range(start: -1m)
+            )~");
+            count = tables.size();
+        }(db, name, count));
+    }
+    loop.Run();
+
+    for (auto count: counts) {
+        EXPECT_EQ(count, 16);
+    }
+}
+
+TEST_F(AsyncTest, should_keep_points_if_flush_fails)
+{
+    influx::EventLoop loop;
+    auto other = db[name];
+    db.DeleteBucket(other);
+
+    bucket << (influx::Measurement("m") << influx::Field("x", 1));
+
+    try {
+        loop.Run(bucket.FlushAsync());
+        EXPECT_TRUE(false);
+    } catch (influx::InfluxRemoteError& e) {
+        EXPECT_EQ(e.statusCode(), 404);
+    }
+
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 1);
+}
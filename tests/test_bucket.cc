@@ -1,3 +1,9 @@
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <type_traits>
+
 #include <gtest/gtest.h>
 
 #include "config.hh"
@@ -105,3 +111,274 @@ TEST_F(BucketTest, should_be_comparable)
     EXPECT_EQ(first, third);
     EXPECT_NE(first, second);
 }
+
+TEST_F(BucketTest, should_share_buffer_between_handles)
+{
+    static_assert(std::is_nothrow_move_constructible_v<influx::Bucket>);
+    static_assert(std::is_nothrow_move_assignable_v<influx::Bucket>);
+
+    auto copy = bucket;
+    copy << (influx::Measurement("m") << influx::Field{"field1", 42});
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 1);
+
+    copy.SetFlushOrder(influx::FlushOrder::Series);
+    EXPECT_EQ(bucket.flushOrder(), influx::FlushOrder::Series);
+
+    auto found = db.GetBucketById(bucket.id());
+    EXPECT_EQ(found.BufferedMeasurementsCount(), 1);
+
+    auto moved = std::move(copy);
+    EXPECT_FALSE(copy);
+    EXPECT_THROW(copy.SetFlushOrder(influx::FlushOrder::Arrival), influx::NullBucketError);
+
+    moved.Flush();
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 0);
+    EXPECT_EQ(found.BufferedMeasurementsCount(), 0);
+}
+
+TEST_F(BucketTest, should_allow_flushing_sorted_by_series)
+{
+    using namespace std::chrono_literals;
+
+    EXPECT_EQ(bucket.flushOrder(), influx::FlushOrder::Arrival);
+    bucket.SetFlushOrder(influx::FlushOrder::Series);
+    EXPECT_EQ(bucket.flushOrder(), influx::FlushOrder::Series);
+
+    auto now = influx::Clock::now();
+    for (int i = 0; i < 10; i++) {
+        bucket << (influx::Measurement("m", now - i * 1s) << influx::Field{"field1", i} << influx::Tag{"host", i % 2 ? "a" : "b"});
+    }
+
+    bucket.Flush();
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 0);
+}
+
+TEST_F(BucketTest, should_serialize_large_batches_in_parallel)
+{
+    bucket.SetSerializationThreads(4);
+    EXPECT_EQ(bucket.serializationThreads(), 4);
+
+    auto now = influx::Clock::now();
+    for (int i = 0; i < 20000; i++) {
+        bucket << (influx::Measurement("m", now - std::chrono::microseconds(i)) << influx::Field{"field1", i} << influx::Tag{"host", std::to_string(i % 10)});
+    }
+
+    bucket.Flush();
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 0);
+
+    auto tables = db.Query(R"~(
+        from(bucket: ")~" + bucket.name() + R"~(")
+            |> range(start: -1m)
+    )~");
+
+    std::size_t records = 0;
+    for (const auto& table: tables) {
+        records += table.size();
+    }
+    EXPECT_EQ(records, 20000);
+}
+
+TEST_F(BucketTest, should_flush_automatically_with_adaptive_batching)
+{
+    EXPECT_FALSE(bucket.batchingState());
+
+    influx::AdaptiveBatching options;
+    options.initialBatchSize = 10;
+    options.minBatchSize = 5;
+    options.increase = 5;
+    options.targetLatency = 10s;
+    bucket.EnableAdaptiveBatching(options);
+
+    ASSERT_TRUE(bucket.batchingState());
+    EXPECT_EQ(bucket.batchingState()->batchSize, 10);
+
+    for (int i = 0; i < 9; i++) {
+        bucket << (influx::Measurement("m") << influx::Field{"field1", i});
+    }
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 9);
+
+    // Reaches the batch size: sent, and the fast write grows the next batch
+    bucket << (influx::Measurement("m") << influx::Field{"field1", 9});
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 0);
+    EXPECT_EQ(bucket.batchingState()->batchSize, 15);
+    EXPECT_EQ(bucket.batchingState()->throttledWrites, 0);
+
+    for (int i = 0; i < 40; i++) {
+        bucket << (influx::Measurement("m") << influx::Field{"field1", i});
+    }
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 5);
+    EXPECT_EQ(bucket.batchingState()->batchSize, 25);
+
+    bucket.Flush();
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 0);
+
+    bucket.DisableAdaptiveBatching();
+    EXPECT_FALSE(bucket.batchingState());
+}
+
+TEST_F(BucketTest, should_apply_overflow_policy_when_buffer_is_full)
+{
+    influx::BufferLimits limits;
+    limits.maxPoints = 3;
+
+    limits.policy = influx::OverflowPolicy::DropNewest;
+    bucket.SetBufferLimits(limits);
+    for (int i = 0; i < 5; i++) {
+        bucket << (influx::Measurement("m") << influx::Field{"field1", i});
+    }
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 3);
+    EXPECT_EQ(bucket.DroppedMeasurementsCount(), 2);
+
+    limits.policy = influx::OverflowPolicy::DropOldest;
+    bucket.SetBufferLimits(limits);
+    bucket << (influx::Measurement("m") << influx::Field{"field1", 5});
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 3);
+    EXPECT_EQ(bucket.DroppedMeasurementsCount(), 3);
+
+    limits.policy = influx::OverflowPolicy::Flush;
+    bucket.SetBufferLimits(limits);
+    bucket << (influx::Measurement("m") << influx::Field{"field1", 6});
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 1);
+    EXPECT_EQ(bucket.DroppedMeasurementsCount(), 3);
+
+    limits.maxPoints = 0;
+    limits.maxBytes = 1;
+    limits.policy = influx::OverflowPolicy::Block;
+    limits.blockTimeout = 10ms;
+    bucket.SetBufferLimits(limits);
+    EXPECT_THROW(bucket << (influx::Measurement("m") << influx::Field{"field1", 7}), influx::BufferFullError);
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 1);
+}
+
+TEST_F(BucketTest, should_unblock_writers_once_flushed)
+{
+    influx::BufferLimits limits;
+    limits.maxPoints = 10;
+    limits.blockTimeout = 10s;
+    bucket.SetBufferLimits(limits);
+
+    std::atomic<bool> done = false;
+    std::thread producer([&]() {
+        for (int i = 0; i < 100; i++) {
+            bucket << (influx::Measurement("m") << influx::Field{"field1", i});
+        }
+        done = true;
+    });
+
+    while (!done) {
+        bucket.Flush();
+        std::this_thread::sleep_for(1ms);
+    }
+    producer.join();
+    bucket.Flush();
+
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 0);
+    EXPECT_EQ(bucket.DroppedMeasurementsCount(), 0);
+}
+
+TEST_F(BucketTest, should_recycle_flushed_measurements)
+{
+    EXPECT_EQ(bucket.measurementPoolSize(), 0);
+    bucket.SetMeasurementPoolSize(2);
+
+    // Names too long to fit in a std::string itself, to tell reused storage
+    const std::string name(64, 'm');
+    for (int i = 0; i < 3; i++) {
+        auto m = bucket.Acquire(name);
+        m.SetTag("host", "a");
+        m.SetField("field1", static_cast<std::int64_t>(i));
+        m.SetField("state", std::string_view("running"));
+        bucket << std::move(m);
+    }
+    bucket.Flush();
+
+    // Two come back from the pool, reset but keeping their storage
+    for (int i = 0; i < 2; i++) {
+        auto m = bucket.Acquire("n", influx::Timestamp(1s));
+        EXPECT_EQ(m, influx::Measurement("n", influx::Timestamp(1s)));
+        EXPECT_GE(m.name().capacity(), name.size());
+    }
+
+    auto fresh = bucket.Acquire("n");
+    EXPECT_LT(fresh.name().capacity(), name.size());
+}
+
+TEST_F(BucketTest, should_accept_borrowed_point_views)
+{
+    const std::string host = "a";
+    const auto now = influx::Clock::now();
+
+    bucket << (influx::Measurement("m", now) << influx::Field{"field1", 1} << influx::Tag{"host", host});
+    for (int i = 0; i < 10; i++) {
+        bucket << (influx::PointView("m", now - (i + 1) * 1ms) << influx::TagView{"host", host} << influx::FieldView{"field1", i} << influx::FieldView{"note", "view"});
+    }
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 11);
+
+    try {
+        bucket << influx::PointView("m");
+        EXPECT_TRUE(false);
+    } catch (influx::InvalidMeasurementError& e) {
+        EXPECT_STREQ(e.what(), "Cannot serialize empty PointView");
+    }
+    EXPECT_THROW((influx::PointView("m") << influx::TagView{"_host", host}), influx::InvalidMeasurementError);
+
+    bucket.Flush();
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 0);
+
+    auto tables = db.Query(R"~(
+        from(bucket: ")~" + bucket.name() + R"~(")
+            |> range(start: -1m)
+            |> filter(fn: (r) => r._field == "field1")
+    )~");
+
+    std::size_t records = 0;
+    for (const auto& table: tables) {
+        records += table.size();
+    }
+    EXPECT_EQ(records, 11);
+}
+
+TEST_F(BucketTest, should_import_line_protocol_files)
+{
+    const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(influx::Clock::now().time_since_epoch()).count();
+    const std::string path = ::testing::TempDir() + "import-" + influx::test::nowstring() + ".lp";
+
+    std::string lines;
+    {
+        std::ofstream file(path);
+        for (int i = 0; i < 1000; i++) {
+            lines += "m,host=" + std::to_string(i % 4) + " field1=" + std::to_string(i) + "i " + std::to_string(now - i * 1000) + "\n";
+        }
+        file << lines;
+    }
+
+    influx::ImportOptions options;
+    options.batchBytes = 4096;
+    options.concurrency = 3;
+
+    influx::ImportStats stats = bucket.Import(path, options);
+    std::remove(path.c_str());
+
+    EXPECT_EQ(stats.bytes, lines.size());
+    EXPECT_GT(stats.requests, lines.size() / 4096);
+    EXPECT_LT(stats.sentBytes, stats.bytes);
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 0);
+
+    auto tables = db.Query(R"~(
+        from(bucket: ")~" + bucket.name() + R"~(")
+            |> range(start: -1m)
+    )~");
+
+    std::size_t records = 0;
+    for (const auto& table: tables) {
+        records += table.size();
+    }
+    EXPECT_EQ(records, 1000);
+
+    options.compressionLevel = 0;
+    stats = bucket.ImportLines("m field1=1i\nm field1=2i", options);
+    EXPECT_EQ(stats.requests, 1);
+    EXPECT_EQ(stats.sentBytes, stats.bytes);
+
+    EXPECT_THROW(bucket.Import(path), influx::InfluxError);
+}
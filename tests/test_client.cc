@@ -0,0 +1,428 @@
+#include <atomic>
+#include <sstream>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <nlohmann/json.hpp>
+
+#include "config.hh"
+#include "stub_server.hh"
+
+#include <influx/async.hh>
+#include <influx/client.hh>
+#include <influx/influx.hh>
+#include <influx/query_cache.hh>
+
+using namespace std::chrono_literals;
+
+#if !defined(_WIN32)
+namespace {
+    influx::test::StubServer::Response FakeInflux(const influx::test::StubServer::Request& request)
+    {
+        if (request.target.starts_with("/api/v2/buckets")) {
+            return {201, nlohmann::json{{"id", "0123"}, {"name", "local"}, {"orgID", "org"}}.dump()};
+        }
+        return {};
+    }
+}
+
+TEST(HttpClientTest, should_connect_through_unix_sockets)
+{
+    const std::string path = ::testing::TempDir() + "influx-" + influx::test::nowstring() + ".sock";
+    influx::test::StubServer server(path, FakeInflux);
+    EXPECT_EQ(server.host(), "unix://" + path);
+
+    influx::Influx db(server.host(), "org", "token");
+    auto bucket = db.CreateBucket("local", 1h);
+    EXPECT_EQ(bucket.id(), "0123");
+
+    bucket << (influx::Measurement("m", influx::Timestamp(1s)) << influx::Field{"field1", 42});
+    bucket.Flush();
+
+    const auto requests = server.requests();
+    ASSERT_EQ(requests.size(), 2);
+    EXPECT_EQ(requests[1].method, "POST");
+    EXPECT_TRUE(requests[1].target.starts_with("/api/v2/write?bucket=0123"));
+    EXPECT_EQ(requests[1].headers.at("host"), "localhost");
+    EXPECT_EQ(requests[1].headers.at("authorization"), "Bearer token");
+    EXPECT_EQ(requests[1].body, "m field1=42i 1000000000\n");
+}
+
+TEST(HttpClientTest, should_reuse_connections_across_copies)
+{
+    influx::test::StubServer server;
+    influx::transport::HttpClient client(server.host(), "org", "token");
+
+    for (int i = 0; i < 5; i++) {
+        influx::transport::HttpClient copy(client);
+        EXPECT_EQ(copy.Get("/ping").status, 204);
+    }
+    EXPECT_EQ(server.requests().size(), 5);
+    EXPECT_EQ(server.connectionCount(), 1);
+}
+
+TEST(HttpClientTest, should_share_connections_between_threads)
+{
+    influx::test::StubServer server(FakeInflux);
+    influx::Influx db(server.host(), "org", "token");
+    auto bucket = db.CreateBucket("local", 1h);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([&db, bucket]() mutable {
+            for (int j = 0; j < 10; j++) {
+                bucket << (influx::Measurement("m") << influx::Field{"field1", j});
+                bucket.Flush();
+                db.QueryRaw("buckets()");
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    // At most one connection per thread, not one per request
+    EXPECT_GT(server.requests().size(), 40);
+    EXPECT_LE(server.connectionCount(), 4);
+}
+
+TEST(HttpClientTest, should_send_prepared_requests)
+{
+    influx::test::StubServer server([](const auto& request) {
+        return influx::test::StubServer::Response{200, request.body + request.body};
+    });
+    influx::transport::HttpClient client(server.host(), "org", "token");
+
+    influx::transport::RequestTemplate empty;
+    EXPECT_FALSE(empty);
+    EXPECT_THROW(client.Post(empty, "body"), influx::InfluxError);
+
+    const auto request = client.Prepare("/api/v2/write?bucket=b", {{"Content-Type", "text/plain"}});
+    ASSERT_TRUE(request);
+
+    influx::transport::HttpClient copy(client);
+    EXPECT_EQ(client.Post(request, "first").body, "firstfirst");
+    EXPECT_EQ(copy.Post(request, std::vector<std::string>{"sec", "ond"}).body, "secondsecond");
+
+    std::string streamed;
+    EXPECT_EQ(client.Post(request, "third", [&](std::string_view data) { streamed += data; }), 200);
+    EXPECT_EQ(streamed, "thirdthird");
+
+    for (const auto& sent: server.requests()) {
+        EXPECT_EQ(sent.target, "/api/v2/write?bucket=b&orgID=org");
+        EXPECT_EQ(sent.headers.at("authorization"), "Bearer token");
+        EXPECT_EQ(sent.headers.at("content-type"), "text/plain");
+    }
+}
+
+TEST(HttpClientTest, should_post_over_native_transport)
+{
+    influx::test::StubServer server([](const auto& request) {
+        if (request.body == "fail") {
+            return influx::test::StubServer::Response{400, R"({"code":"invalid"})"};
+        }
+        return influx::test::StubServer::Response{};
+    });
+    influx::transport::HttpClient client(server.host(), "org", "token");
+    client.SetWriteTransport(influx::transport::WriteTransport::Native);
+    EXPECT_EQ(client.writeTransport(), influx::transport::WriteTransport::Native);
+
+    const auto request = client.Prepare("/api/v2/write?bucket=b", {{"Content-Type", "text/plain"}});
+    EXPECT_EQ(client.Post(request, std::vector<std::string>{"m f=1i 1\n", "", "m f=2i 2\n"}).status, 204);
+    EXPECT_THROW(client.Post(request, "fail"), influx::InfluxRemoteError);
+    EXPECT_EQ(client.Post(request, "m f=3i 3\n").status, 204);
+
+    const auto requests = server.requests();
+    ASSERT_EQ(requests.size(), 3);
+    EXPECT_EQ(requests[0].method, "POST");
+    EXPECT_EQ(requests[0].target, "/api/v2/write?bucket=b&orgID=org");
+    EXPECT_EQ(requests[0].headers.at("host"), server.host().substr(7));
+    EXPECT_EQ(requests[0].headers.at("authorization"), "Bearer token");
+    EXPECT_EQ(requests[0].headers.at("content-type"), "text/plain");
+    EXPECT_EQ(requests[0].body, "m f=1i 1\nm f=2i 2\n");
+    EXPECT_EQ(requests[2].body, "m f=3i 3\n");
+    EXPECT_EQ(server.connectionCount(), 1);
+
+    influx::transport::HttpClient secure("https://localhost:8086", "org", "token");
+    EXPECT_THROW(secure.SetWriteTransport(influx::transport::WriteTransport::Native), influx::InfluxError);
+}
+
+TEST(HttpClientTest, should_close_native_connection_on_malformed_response)
+{
+    influx::test::StubServer server([](const auto& request) {
+        influx::test::StubServer::Response response;
+        if (request.body == "length") {
+            response.raw = "HTTP/1.1 200 OK\r\nContent-Length: many\r\n\r\n";
+        } else if (request.body == "chunk") {
+            response.raw = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n";
+        }
+        return response;
+    });
+    influx::transport::HttpClient client(server.host(), "org", "token");
+    client.SetWriteTransport(influx::transport::WriteTransport::Native);
+
+    const auto request = client.Prepare("/api/v2/write?bucket=b", {});
+    EXPECT_THROW(client.Post(request, "length"), influx::InfluxError);
+    EXPECT_EQ(client.Post(request, "m f=1i 1\n").status, 204);
+    EXPECT_THROW(client.Post(request, "chunk"), influx::InfluxError);
+    EXPECT_EQ(client.Post(request, "m f=2i 2\n").status, 204);
+    EXPECT_EQ(server.connectionCount(), 3);
+}
+
+TEST(HttpClientTest, should_write_buckets_over_native_transport)
+{
+    const std::string path = ::testing::TempDir() + "influx-native-" + influx::test::nowstring() + ".sock";
+    influx::test::StubServer server(path, FakeInflux);
+
+    influx::Influx db(server.host(), "org", "token");
+    auto bucket = db.CreateBucket("local", 1h);
+    bucket.SetWriteTransport(influx::transport::WriteTransport::Native);
+
+    for (int i = 1; i <= 3; i++) {
+        bucket << (influx::Measurement("m", influx::Timestamp(std::chrono::seconds(i))) << influx::Field{"field1", i});
+        bucket.Flush();
+    }
+
+    const auto requests = server.requests();
+    ASSERT_EQ(requests.size(), 4);
+    EXPECT_TRUE(requests[3].target.starts_with("/api/v2/write?bucket=0123"));
+    EXPECT_EQ(requests[3].headers.at("host"), "localhost");
+    EXPECT_EQ(requests[3].body, "m field1=3i 3000000000\n");
+    EXPECT_EQ(server.connectionCount(), 2);  // libcurl's, then the native one
+}
+
+TEST(HttpClientTest, should_share_bucket_pipelines_until_deleted)
+{
+    // Every bucket the fake creates has the same id
+    influx::test::StubServer server(FakeInflux);
+    influx::Influx db(server.host(), "org", "token");
+
+    auto bucket = db.CreateBucket("local", 1h);
+    auto live = bucket;
+    live << (influx::Measurement("m") << influx::Field{"field1", 1});
+
+    // Live pipelines keep the settings they were created with
+    db.SetRequestOptions({.timeout = 5s});
+    auto again = db.GetBucketById(bucket.id());
+    EXPECT_EQ(again.BufferedMeasurementsCount(), 1);
+    EXPECT_EQ(again.requestOptions().timeout, 0ms);
+
+    db.DeleteBucket(bucket);
+    EXPECT_FALSE(bucket);
+    EXPECT_EQ(live.BufferedMeasurementsCount(), 1);
+
+    // A bucket created after the delete starts over, even with the same id
+    auto recreated = db.CreateBucket("local", 1h);
+    EXPECT_EQ(recreated.id(), live.id());
+    EXPECT_EQ(recreated.BufferedMeasurementsCount(), 0);
+    EXPECT_EQ(recreated.requestOptions().timeout, 5s);
+}
+
+TEST(HttpClientTest, should_flush_asynchronously_in_adaptive_batches)
+{
+    influx::test::StubServer server(FakeInflux);
+    influx::Influx db(server.host(), "org", "token");
+    auto bucket = db.CreateBucket("local", 1h);
+
+    for (int i = 0; i < 5; i++) {
+        bucket << (influx::Measurement("m", influx::Timestamp(std::chrono::seconds(i + 1))) << influx::Field{"field1", i});
+    }
+    bucket.EnableAdaptiveBatching({.initialBatchSize = 2, .minBatchSize = 1, .increase = 0});
+
+    influx::EventLoop loop;
+    loop.Run(bucket.FlushAsync());
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 0);
+
+    const auto requests = server.requests();
+    ASSERT_EQ(requests.size(), 4);
+    EXPECT_EQ(requests[1].body, "m field1=0i 1000000000\nm field1=1i 2000000000\n");
+    EXPECT_EQ(requests[3].body, "m field1=4i 5000000000\n");
+}
+
+TEST(HttpClientTest, should_flush_partial_batches_after_max_delay)
+{
+    influx::test::StubServer server(FakeInflux);
+    influx::Influx db(server.host(), "org", "token");
+    auto bucket = db.CreateBucket("local", 1h);
+    bucket.EnableAdaptiveBatching({.initialBatchSize = 100, .maxDelay = 50ms});
+
+    bucket << (influx::Measurement("m", influx::Timestamp(1s)) << influx::Field{"field1", 0});
+    EXPECT_EQ(server.requests().size(), 1);
+
+    std::this_thread::sleep_for(60ms);
+    bucket << (influx::Measurement("m", influx::Timestamp(2s)) << influx::Field{"field1", 1});
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 0);
+
+    const auto requests = server.requests();
+    ASSERT_EQ(requests.size(), 2);
+    EXPECT_EQ(requests[1].body, "m field1=0i 1000000000\nm field1=1i 2000000000\n");
+}
+
+TEST(HttpClientTest, should_back_off_while_throttled)
+{
+    std::atomic<bool> throttling = true;
+    influx::test::StubServer server([&](const auto& request) {
+        if (throttling && request.target.starts_with("/api/v2/write")) {
+            return influx::test::StubServer::Response{429, R"({"code":"too many requests"})"};
+        }
+        return FakeInflux(request);
+    });
+    influx::Influx db(server.host(), "org", "token");
+    auto bucket = db.CreateBucket("local", 1h);
+    bucket.EnableAdaptiveBatching({.initialBatchSize = 8, .minBatchSize = 1, .increase = 0, .initialBackoff = 10s});
+
+    // A full batch flushes on its own, and stays buffered when throttled
+    for (int i = 0; i < 8; i++) {
+        bucket << (influx::Measurement("m") << influx::Field{"field1", i});
+    }
+    EXPECT_EQ(server.requests().size(), 2);
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 8);
+    EXPECT_EQ(bucket.batchingState()->throttledWrites, 1);
+    EXPECT_EQ(bucket.batchingState()->batchSize, 4);
+    EXPECT_EQ(bucket.batchingState()->backoff, 10s);
+
+    // No automatic flush while backing off
+    bucket << (influx::Measurement("m") << influx::Field{"field1", 8});
+    EXPECT_EQ(server.requests().size(), 2);
+
+    try {
+        bucket.Flush();
+        EXPECT_TRUE(false);
+    } catch (influx::InfluxRemoteError& e) {
+        EXPECT_EQ(e.statusCode(), 429);
+    }
+    EXPECT_EQ(bucket.batchingState()->throttledWrites, 2);
+    EXPECT_EQ(bucket.batchingState()->batchSize, 2);
+    EXPECT_EQ(bucket.batchingState()->backoff, 20s);
+
+    throttling = false;
+    bucket.Flush();
+    EXPECT_EQ(bucket.BufferedMeasurementsCount(), 0);
+    EXPECT_EQ(server.requests().size(), 3 + 5);
+    EXPECT_EQ(bucket.batchingState()->backoff, 0s);
+}
+
+TEST(HttpClientTest, should_send_points_sorted_by_series)
+{
+    influx::test::StubServer server(FakeInflux);
+    influx::Influx db(server.host(), "org", "token");
+    auto bucket = db.CreateBucket("local", 1h);
+    bucket.SetFlushOrder(influx::FlushOrder::Series);
+
+    // Interleaved series, each written newest first
+    for (int i = 0; i < 6; i++) {
+        bucket << (influx::Measurement("m", influx::Timestamp(std::chrono::seconds(10 - i))) << influx::Field{"field1", i} << influx::Tag{"host", i % 2 ? "a" : "b"});
+    }
+    bucket.Flush();
+
+    const auto requests = server.requests();
+    ASSERT_EQ(requests.size(), 2);
+    const std::string& body = requests[1].body;
+
+    // Either series may come first, but each is contiguous and in time order
+    const std::string a =
+        "m,host=a field1=5i 5000000000\n"
+        "m,host=a field1=3i 7000000000\n"
+        "m,host=a field1=1i 9000000000\n";
+    const std::string b =
+        "m,host=b field1=4i 6000000000\n"
+        "m,host=b field1=2i 8000000000\n"
+        "m,host=b field1=0i 10000000000\n";
+    EXPECT_TRUE(body == a + b || body == b + a) << body;
+}
+
+TEST(HttpClientTest, should_end_bucket_range_on_failed_page)
+{
+    influx::test::StubServer server([](const auto& request) {
+        if (request.target.find("offset=0") == std::string::npos) {
+            return influx::test::StubServer::Response{500, R"({"message":"down"})"};
+        }
+        return influx::test::StubServer::Response{200, R"({"buckets":[{"id":"0123","name":"local","orgID":"org"}]})"};
+    });
+    influx::Influx db(server.host(), "org", "token");
+
+    auto range = db.Buckets(1);
+    auto it = range.begin();
+    ASSERT_FALSE(it == range.end());
+    EXPECT_EQ(it->name, "local");
+
+    EXPECT_THROW(++it, influx::InfluxRemoteError);
+    EXPECT_TRUE(it == range.end());
+    ++it;
+    EXPECT_TRUE(it == range.end());
+}
+
+TEST(HttpClientTest, should_export_error_tags_as_line_protocol)
+{
+    influx::test::StubServer server([](const auto& request) {
+        if (request.body.find("fail") != std::string::npos) {
+            return influx::test::StubServer::Response{200, "#datatype,string,string\r\n,error,reference\r\n,query failed,897\r\n"};
+        }
+        return influx::test::StubServer::Response{200,
+            "#datatype,string,long,dateTime:RFC3339,double,string,string,string\r\n"
+            ",result,table,_time,_value,_field,_measurement,error\r\n"
+            ",_result,0,1970-01-01T00:00:01Z,1.5,x,m,timeout\r\n"};
+    });
+    influx::Influx db(server.host(), "org", "token");
+
+    std::ostringstream lines;
+    db.Export("from(bucket: \"local\")", lines, influx::ExportFormat::LineProtocol);
+    EXPECT_EQ(lines.str(), "m,error=timeout x=1.5 1000000000\n");
+
+    std::ostringstream failed;
+    EXPECT_THROW(db.Export("fail", failed, influx::ExportFormat::LineProtocol), influx::InfluxRemoteError);
+}
+
+TEST(QueryCacheStubTest, should_answer_other_queries_while_one_runs)
+{
+    std::atomic<bool> answered = false;
+    influx::test::StubServer server([&](const auto& request) {
+        for (int i = 0; i < 200 && request.body.find("slow") != std::string::npos && !answered; i++) {
+            std::this_thread::sleep_for(10ms);
+        }
+        return influx::test::StubServer::Response{200, "#datatype,string,long,double\r\n,result,table,_value\r\n,_result,0,1\r\n"};
+    });
+    influx::Influx db(server.host(), "org", "token");
+    influx::QueryCache cache(db);
+    const influx::Timestamp start(1s);
+
+    std::thread slow([&]() { cache.Query("slow", start, start + 1min); });
+    std::this_thread::sleep_for(50ms);
+
+    const auto before = std::chrono::steady_clock::now();
+    EXPECT_EQ(cache.Query("fast", start, start + 1min).size(), 1);
+    EXPECT_LT(std::chrono::steady_clock::now() - before, 1s);
+
+    answered = true;
+    slow.join();
+    EXPECT_EQ(cache.size(), 2);
+}
+
+TEST(RequestOptionsTest, should_apply_to_background_requests)
+{
+    std::atomic<bool> slow = false;
+    influx::test::StubServer server([&](const auto& request) {
+        if (slow) {
+            std::this_thread::sleep_for(3s);
+        }
+        return FakeInflux(request);
+    });
+
+    influx::Influx db(server.host(), "org", "token");
+    auto bucket = db.CreateBucket("local", 1h);
+    slow = true;
+
+    influx::ImportOptions options;
+    options.batchBytes = 8;
+    options.concurrency = 4;
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        influx::RequestScope scope({.timeout = 200ms});
+        EXPECT_THROW(bucket.ImportLines("m f=1i\nm f=2i\nm f=3i\nm f=4i\n", options), influx::TimeoutError);
+        EXPECT_THROW(db.Buckets().begin(), influx::TimeoutError);
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 2s);
+}
+#endif
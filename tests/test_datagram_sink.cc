@@ -0,0 +1,142 @@
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// Datagram sinks are POSIX only
+#if !defined(_WIN32)
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "config.hh"
+
+#include <influx/datagram_sink.hh>
+
+namespace {
+    /* Bound datagram socket standing in for Telegraf's socket_listener */
+    class Listener {
+    public:
+        Listener()
+            : fd_(socket(AF_INET, SOCK_DGRAM, 0))
+        {
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(addr);
+
+            bind(fd_, reinterpret_cast<sockaddr*>(&addr), length);
+            getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &length);
+            address_ = "udp://127.0.0.1:" + std::to_string(ntohs(addr.sin_port));
+        }
+
+        explicit Listener(const std::string& path)
+            : fd_(socket(AF_UNIX, SOCK_DGRAM, 0))
+            , path_(path)
+        {
+            sockaddr_un addr = {};
+            addr.sun_family = AF_UNIX;
+            path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+
+            unlink(path.c_str());
+            bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+            address_ = "unixgram://" + path;
+        }
+
+        ~Listener()
+        {
+            close(fd_);
+            if (!path_.empty()) {
+                unlink(path_.c_str());
+            }
+        }
+
+        const std::string& address() const { return address_; }
+
+        /* Datagrams received until none arrives for a while */
+        std::vector<std::string> receive()
+        {
+            std::vector<std::string> datagrams;
+            pollfd pfd = {fd_, POLLIN, 0};
+            while (poll(&pfd, 1, 200) > 0) {
+                char buffer[65536];
+                const ssize_t n = recv(fd_, buffer, sizeof(buffer), 0);
+                datagrams.emplace_back(buffer, static_cast<std::size_t>(n));
+            }
+            return datagrams;
+        }
+
+    private:
+        int fd_;
+        std::string path_;
+        std::string address_;
+    };
+}
+
+TEST(DatagramSinkTest, should_pack_lines_into_datagrams)
+{
+    Listener listener;
+
+    influx::DatagramOptions options;
+    options.maxDatagramSize = 100;
+    options.batchDatagrams = 4;
+    influx::DatagramSink sink(listener.address(), options);
+
+    std::string expected;
+    for (int i = 0; i < 50; i++) {
+        const auto timestamp = influx::Timestamp(std::chrono::seconds(i + 1));
+        sink << (influx::Measurement("m", timestamp) << influx::Field{"field1", i} << influx::Tag{"host", "a"});
+        expected += "m,host=a field1=" + std::to_string(i) + "i " + std::to_string(i + 1) + "000000000\n";
+    }
+    EXPECT_GT(sink.stats().datagrams, 0);
+    EXPECT_LT(sink.BufferedBytes(), 4 * options.maxDatagramSize);
+
+    sink.Flush();
+    EXPECT_EQ(sink.BufferedBytes(), 0);
+
+    const auto datagrams = listener.receive();
+    std::string received;
+    for (const auto& datagram: datagrams) {
+        EXPECT_LE(datagram.size(), options.maxDatagramSize);
+        EXPECT_EQ(datagram.back(), '\n');
+        received += datagram;
+    }
+    EXPECT_EQ(received, expected);
+
+    const auto stats = sink.stats();
+    EXPECT_EQ(stats.points, 50);
+    EXPECT_EQ(stats.datagrams, datagrams.size());
+    EXPECT_EQ(stats.bytes, expected.size());
+    EXPECT_EQ(stats.failedDatagrams, 0);
+}
+
+TEST(DatagramSinkTest, should_send_over_unix_datagram_sockets)
+{
+    Listener listener(::testing::TempDir() + "datagram-" + influx::test::nowstring() + ".sock");
+    {
+        influx::DatagramSink sink(listener.address());
+        sink << (influx::PointView("m", influx::Timestamp(std::chrono::seconds(1))) << influx::FieldView{"field1", 1.5});
+
+        // A line longer than a datagram goes alone
+        sink << (influx::Measurement("m", influx::Timestamp(std::chrono::seconds(2))) << influx::Field{"note", std::string(2000, 'x')});
+    }
+
+    const auto datagrams = listener.receive();
+    ASSERT_EQ(datagrams.size(), 2);
+    EXPECT_EQ(datagrams[0], "m field1=1.5 1000000000\n");
+    EXPECT_EQ(datagrams[1], "m note=\"" + std::string(2000, 'x') + "\" 2000000000\n");
+}
+
+TEST(DatagramSinkTest, should_reject_invalid_addresses)
+{
+    EXPECT_THROW(influx::DatagramSink("http://localhost:8094"), influx::InfluxError);
+    EXPECT_THROW(influx::DatagramSink("udp://localhost"), influx::InfluxError);
+    EXPECT_THROW(influx::DatagramSink("unixgram:///nonexistent/telegraf.sock"), influx::InfluxError);
+
+    influx::DatagramSink null;
+    EXPECT_FALSE(null);
+    EXPECT_THROW(null << (influx::Measurement("m") << influx::Field{"field1", 1}), influx::InfluxError);
+}
+#endif
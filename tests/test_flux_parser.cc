@@ -1,4 +1,5 @@
 #include <iostream>
+#include <limits>
 
 #include <gtest/gtest.h>
 
@@ -66,3 +67,188 @@ TEST(FluxParserTest, should_parse_query_static)
     EXPECT_EQ(tables[0][0].tags.at("domain"), "1");
     EXPECT_EQ(tables[2][0].tags.at("client"), "2");
 }
+
+TEST(FluxParserTest, should_parse_response_fed_in_pieces)
+{
+    const std::string body =
+        "#datatype,string,long,dateTime:RFC3339,dateTime:RFC3339,dateTime:RFC3339,double,string,string,string\r\n"
+        ",result,table,_start,_stop,_time,_value,_field,_measurement,domain\r\n"
+        ",acqui,0,2022-02-26T17:51:31.687426831Z,2022-02-26T17:51:51.687426831Z,2022-02-26T17:51:36.590333377Z,20,x,acquisition,1\r\n"
+        ",acqui,1,2022-02-26T17:51:31.687426831Z,2022-02-26T17:51:51.687426831Z,2022-02-26T17:51:41.590333377Z,10,x,acquisition,2";
+
+    const auto expected = influx::FluxParser().parse(body);
+    ASSERT_EQ(expected.size(), 2);
+
+    for (std::size_t piece: {1, 7, 64}) {
+        influx::FluxParser parser;
+        for (std::size_t i = 0; i < body.size(); i += piece) {
+            parser.feed(std::string_view(body).substr(i, piece));
+        }
+
+        auto tables = parser.finish();
+        ASSERT_EQ(tables.size(), expected.size());
+        EXPECT_EQ(tables[1][0].time, expected[1][0].time);
+        EXPECT_EQ(tables[1][0].value, expected[1][0].value);
+        EXPECT_EQ(tables[1][0].tags, expected[1][0].tags);
+        EXPECT_TRUE(parser.finish().empty());
+    }
+}
+
+TEST(FluxParserTest, should_parse_quoted_cells)
+{
+    const std::string body =
+        "#datatype,string,long,dateTime:RFC3339,string,string,string,string\r\n"
+        ",result,table,_time,_value,_field,_measurement,host\r\n"
+        ",,0,2022-02-26T17:51:36Z,\"a, \"\"quoted\"\"\nvalue\",msg,log,\"eu,1\"\r\n"
+        ",,0,2022-02-26T17:51:37Z,plain,msg,log,\"eu,1\"\r\n";
+
+    for (std::size_t piece: {1, 5, 4096}) {
+        influx::FluxParser parser;
+        for (std::size_t i = 0; i < body.size(); i += piece) {
+            parser.feed(std::string_view(body).substr(i, piece));
+        }
+
+        auto tables = parser.finish();
+        ASSERT_EQ(tables.size(), 1);
+        ASSERT_EQ(tables[0].size(), 2);
+        EXPECT_EQ(std::get<std::string>(tables[0][0].value), "a, \"quoted\"\nvalue");
+        EXPECT_EQ(tables[0][0].field, "msg");
+        EXPECT_EQ(tables[0][0].measurement, "log");
+        EXPECT_EQ(tables[0][0].tags.at("host"), "eu,1");
+        EXPECT_EQ(std::get<std::string>(tables[0][1].value), "plain");
+        EXPECT_EQ(tables[0][1].tags.at("host"), "eu,1");
+    }
+}
+
+TEST(FluxParserTest, should_parse_timestamps_to_the_nanosecond)
+{
+    auto tables = influx::FluxParser().parse(
+        "#datatype,string,long,dateTime:RFC3339,dateTime:RFC3339,dateTime:RFC3339,long\n"
+        ",result,table,_start,_stop,_time,_value\n"
+        ",_result,0,2026-10-19T10:00:00.252454123Z,2026-10-19T10:00:01.5Z,2026-10-19T10:00:00Z,1\n"
+    );
+
+    ASSERT_EQ(tables.size(), 1);
+    EXPECT_EQ(tables[0][0].start, 1792404000252454123ns);
+    EXPECT_EQ(tables[0][0].stop,  1792404001500000000ns);
+    EXPECT_EQ(tables[0][0].time,  1792404000000000000ns);
+}
+
+TEST(FluxParserTest, should_share_repeated_strings_and_tags)
+{
+    auto tables = influx::FluxParser().parse(R"~~(
+#datatype,string,long,dateTime:RFC3339,double,string,string,string,string
+,result,table,_time,_value,_field,_measurement,host,region
+,_result,0,2022-02-26T17:51:36Z,1,x,m,a,eu
+,_result,0,2022-02-26T17:51:37Z,2,x,m,a,eu
+,_result,0,2022-02-26T17:51:38Z,3,x,m,a,us
+,_result,1,2022-02-26T17:51:36Z,4,x,m,b,eu
+)~~");
+
+    ASSERT_EQ(tables.size(), 2);
+    ASSERT_EQ(tables[0].size(), 3);
+
+    const auto& first = tables[0][0];
+    const auto& second = tables[0][1];
+    EXPECT_EQ(&first.tags.map(), &second.tags.map());
+    EXPECT_EQ(&first.field.str(), &tables[1][0].field.str());
+    EXPECT_EQ(&first.measurement.str(), &second.measurement.str());
+
+    EXPECT_EQ(first.tags, (influx::FluxTags::Map{{"host", "a"}, {"region", "eu"}}));
+    EXPECT_EQ(tables[0][2].tags.at("region"), "us");
+    EXPECT_NE(first.tags, tables[0][2].tags);
+    EXPECT_EQ(tables[1][0].tags.at("host"), "b");
+    EXPECT_EQ(first.field, "x");
+    EXPECT_EQ(first.name, std::string("_result"));
+}
+
+namespace {
+    struct Sample {
+        influx::Timestamp time;
+        double value = -1;
+        std::string host;
+        std::int64_t table = -1;
+    };
+}
+
+TEST(FluxParserTest, should_decode_rows_into_bound_members)
+{
+    const std::string body =
+        "#datatype,string,long,dateTime:RFC3339,double,string,string\r\n"
+        ",result,table,_time,_value,_field,host\r\n"
+        ",_result,0,2022-02-26T17:51:36.000000001Z,1.5,x,\"a,b\"\r\n"
+        ",_result,0,2022-02-26T17:51:37Z,,x,a\r\n"
+        ",_result,1,2022-02-26T17:51:38Z,3,x,c\r\n";
+
+    influx::FluxRowParser parser(
+        influx::Bind("_time", &Sample::time),
+        influx::Bind("_value", &Sample::value),
+        influx::Bind("host", &Sample::host),
+        influx::Bind("table", &Sample::table)
+    );
+    for (std::size_t i = 0; i < body.size(); i += 7) {
+        parser.feed(std::string_view(body).substr(i, 7));
+    }
+    const auto tables = parser.finish();
+
+    ASSERT_EQ(tables.size(), 2);
+    ASSERT_EQ(tables[0].size(), 2);
+    EXPECT_EQ(tables[0][0].time, 1645897896000000001ns);
+    EXPECT_EQ(tables[0][0].value, 1.5);
+    EXPECT_EQ(tables[0][0].host, "a,b");
+    EXPECT_EQ(tables[0][0].table, 0);
+    EXPECT_EQ(tables[0][1].value, -1);  // null
+    EXPECT_EQ(tables[1][0].host, "c");
+    EXPECT_EQ(tables[1][0].table, 1);
+
+    influx::FluxRowParser mistyped(influx::Bind("_value", &Sample::table));
+    try {
+        mistyped.feed(body);
+        FAIL();
+    } catch (const influx::FluxColumnError& e) {
+        EXPECT_EQ(e.column(), "_value");
+    }
+
+    influx::FluxRowParser missing(influx::Bind("region", &Sample::host));
+    EXPECT_THROW(missing.feed(body), influx::FluxColumnError);
+}
+
+TEST(FluxParserTest, should_reject_malformed_double_cells)
+{
+    influx::FluxRowParser parser(influx::Bind("_value", &Sample::value));
+    parser.feed("#datatype,string,long,double\r\n,result,table,_value\r\n,_result,0,+Inf\r\n");
+    const auto tables = parser.finish();
+    ASSERT_EQ(tables.size(), 1);
+    EXPECT_EQ(tables[0][0].value, std::numeric_limits<double>::infinity());
+
+    EXPECT_THROW(parser.feed(",_result,0,1.5x\r\n"), influx::InfluxError);
+
+    influx::FluxParser records;
+    EXPECT_THROW(records.feed("#datatype,string,long,double\r\n,result,table,_value\r\n,_result,0,abc\r\n"), influx::InfluxError);
+}
+
+TEST(FluxParserTest, should_tell_error_tags_from_error_tables)
+{
+    influx::FluxRowParser parser(influx::Bind("_value", &Sample::value), influx::Bind("error", &Sample::host));
+    parser.feed(
+        "#datatype,string,long,double,string\r\n"
+        ",result,table,_value,error\r\n"
+        ",_result,0,1.5,timeout\r\n"
+    );
+    const auto tables = parser.finish();
+    ASSERT_EQ(tables.size(), 1);
+    EXPECT_EQ(tables[0][0].value, 1.5);
+    EXPECT_EQ(tables[0][0].host, "timeout");
+
+    try {
+        parser.feed(
+            "#datatype,string,string\r\n"
+            ",error,reference\r\n"
+            ",query failed,897\r\n"
+        );
+        FAIL();
+    } catch (const influx::InfluxRemoteError& e) {
+        EXPECT_EQ(e.statusCode(), 200);
+        EXPECT_STREQ(e.what(), "query failed");
+    }
+}
@@ -1,3 +1,13 @@
+#include <set>
+#include <sstream>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
 #include <gtest/gtest.h>
 
 #include "config.hh"
@@ -8,6 +18,36 @@
 
 using namespace std::chrono_literals;
 
+#if !defined(_WIN32)
+namespace {
+    /* Listening socket whose connections are queued but never answered */
+    class SilentServer {
+    public:
+        SilentServer()
+            : fd_(socket(AF_INET, SOCK_STREAM, 0))
+        {
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(addr);
+
+            bind(fd_, reinterpret_cast<sockaddr*>(&addr), length);
+            listen(fd_, 8);
+            getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &length);
+            port_ = ntohs(addr.sin_port);
+        }
+
+        ~SilentServer() { close(fd_); }
+
+        std::string host() const { return "http://127.0.0.1:" + std::to_string(port_); }
+
+    private:
+        int fd_;
+        int port_ = 0;
+    };
+}
+#endif
+
 class InfluxTest: public ::testing::Test {
 protected:
     influx::Influx db = influx::test::db();
@@ -101,6 +141,34 @@ TEST_F(InfluxTest, should_list_all_buckets_with_paging)
     }
 }
 
+TEST_F(InfluxTest, should_enumerate_all_buckets_lazily)
+{
+    for (int i = 0; i < 5; i++) {
+        db.CreateBucket("test-bucket-" + std::to_string(i), 1h);
+    }
+
+    std::vector<std::string> names;
+    for (const influx::BucketInfo& info: db.Buckets(2)) {
+        EXPECT_FALSE(info.id.empty());
+        EXPECT_FALSE(info.orgId.empty());
+        names.push_back(info.name);
+    }
+
+    // If you fail here, check that your token is an all-access token.
+    ASSERT_EQ(names.size(), 7);
+    EXPECT_EQ(names[0], "_monitoring");
+    EXPECT_EQ(names[1], "_tasks");
+    EXPECT_EQ(names[6], "test-bucket-4");
+
+    auto buckets = db.Buckets();
+    auto it = std::ranges::find_if(buckets, [](const auto& info) { return info.name == "test-bucket-3"; });
+    ASSERT_NE(it, buckets.end());
+
+    auto bucket = db.GetBucket(*it);
+    EXPECT_EQ(bucket.name(), "test-bucket-3");
+    EXPECT_FALSE(bucket.is_system_bucket());
+}
+
 TEST_F(InfluxTest, should_throw_if_invalid_limit_passed)
 {
     try {
@@ -169,6 +237,81 @@ TEST_F(InfluxTest, should_get_single_bucket_by_name)
     }
 }
 
+TEST_F(InfluxTest, should_cache_bucket_lookups)
+{
+    auto name = influx::test::nowstring();
+    auto id = db.CreateBucket(name, 1h).id();
+
+    // Deleted behind the cache's back
+    auto other = influx::test::db();
+    auto bucket = other.GetBucketById(id);
+    other.DeleteBucket(bucket);
+
+    EXPECT_EQ(db[name].id(), id);
+    EXPECT_EQ(db.GetBucketById(id).name(), name);
+
+    db.InvalidateBucketCache();
+    EXPECT_FALSE(db[name]);
+}
+
+TEST_F(InfluxTest, should_invalidate_cache_on_delete)
+{
+    auto name = influx::test::nowstring();
+    auto bucket = db.CreateBucket(name, 1h);
+    EXPECT_TRUE(db[name]);
+
+    db.DeleteBucket(bucket);
+    EXPECT_FALSE(db[name]);
+}
+
+TEST_F(InfluxTest, should_share_connections_between_threads)
+{
+    EXPECT_EQ(db.httpVersion(), influx::transport::HttpVersion::Auto);
+    db.SetHttpVersion(influx::transport::HttpVersion::Http2);
+    EXPECT_EQ(db.httpVersion(), influx::transport::HttpVersion::Http2);
+
+    auto name = influx::test::nowstring();
+    auto bucket = db.CreateBucket(name, 1h);
+    const auto now = influx::Clock::now();
+
+    std::vector<std::thread> writers;
+    for (int i = 0; i < 4; i++) {
+        writers.emplace_back([&, i, bucket]() mutable {
+            for (int j = 0; j < 10; j++) {
+                bucket << (influx::Measurement("m", now - (i * 10 + j) * 1ms) << influx::Field("x", j) << influx::Tag("writer", std::to_string(i)));
+                bucket.Flush();
+            }
+        });
+    }
+    for (auto& writer: writers) {
+        writer.join();
+    }
+
+    auto tables = db.Query(R"~(
+        from(bucket: ")~" + name + R"~(")
+            |> range(start: -1m)
+    )~");
+
+    std::size_t records = 0;
+    for (const auto& table: tables) {
+        records += table.size();
+    }
+    EXPECT_EQ(records, 40);
+}
+
+TEST_F(InfluxTest, should_not_cache_if_ttl_is_zero)
+{
+    db.SetBucketCacheTtl(0s);
+
+    auto name = influx::test::nowstring();
+    auto id = db.CreateBucket(name, 1h).id();
+
+    auto other = influx::test::db();
+    auto bucket = other.GetBucketById(id);
+    other.DeleteBucket(bucket);
+
+    EXPECT_FALSE(db[name]);
+}
 
 TEST_F(InfluxTest, should_return_invalid_bucket_if_name_empty)
 {
@@ -204,7 +347,215 @@ TEST_F(InfluxTest, should_return_parsed_query)
     ASSERT_EQ(tables[1].size(), 1);
     EXPECT_TRUE(std::holds_alternative<std::int64_t>(tables[1][0].value));
     EXPECT_EQ(std::get<std::int64_t>(tables[1][0].value), 30);
+
+    // A fixed range, so that both responses are identical
+    const std::string flux = R"~(
+        from(bucket: ")~" + name + R"~(")
+            |> range(start: v.timeRangeStart, stop: v.timeRangeStop)
+    )~";
+    const auto stop = influx::Clock::now();
+
+    EXPECT_TRUE(db.responseCompression());
+    db.SetResponseCompression(false);
+    auto uncompressed = db.QueryRaw(flux, stop - 20s, stop);
+    db.SetResponseCompression(true);
+    auto compressed = db.QueryRaw(flux, stop - 20s, stop);
+    EXPECT_EQ(compressed, uncompressed);
+}
+
+TEST_F(InfluxTest, should_decode_typed_query_rows)
+{
+    struct Row {
+        influx::Timestamp time;
+        double value = 0;
+        std::string domain;
+    };
+
+    auto name = influx::test::nowstring();
+    auto bucket = db.CreateBucket(name, 1h);
+    auto now = influx::Clock::now() - std::chrono::seconds(15);
+
+    bucket
+        << (influx::Measurement("acquisition", now +  0s) << influx::Field("x", 20.0) << influx::Tag("domain", "1"))
+        << (influx::Measurement("acquisition", now +  5s) << influx::Field("x", 10.0) << influx::Tag("domain", "1"));
+    bucket.Flush();
+
+    const std::string flux = R"~(
+        from(bucket: ")~" + name + R"~(")
+            |> range(start: -20s)
+    )~";
+
+    auto tables = db.Query(flux,
+        influx::Bind("_time", &Row::time),
+        influx::Bind("_value", &Row::value),
+        influx::Bind("domain", &Row::domain));
+
+    ASSERT_EQ(tables.size(), 1);
+    ASSERT_EQ(tables[0].size(), 2);
+    EXPECT_EQ(tables[0][0].value, 20.0);
+    EXPECT_EQ(tables[0][1].value, 10.0);
+    EXPECT_EQ(tables[0][1].domain, "1");
+    EXPECT_EQ(std::chrono::duration_cast<std::chrono::microseconds>(tables[0][1].time - tables[0][0].time), 5s);
+
+    EXPECT_THROW(db.Query(flux, influx::Bind("_value", &Row::domain)), influx::FluxColumnError);
+}
+
+TEST_F(InfluxTest, should_split_range_queries_across_parallel_requests)
+{
+    auto name = influx::test::nowstring();
+    auto bucket = db.CreateBucket(name, 1h);
+    const auto stop = influx::Clock::now();
+    const auto start = stop - 10min;
+
+    for (int i = 0; i < 100; i++) {
+        bucket << (influx::Measurement("m", start + i * 6s) << influx::Field("x", i) << influx::Tag("host", i % 2 ? "a" : "b"));
+    }
+    bucket.Flush();
+
+    const std::string flux = R"~(
+        from(bucket: ")~" + name + R"~(")
+            |> range(start: v.timeRangeStart, stop: v.timeRangeStop)
+    )~";
+
+    const auto expected = db.Query(flux, start, stop);
+    ASSERT_EQ(expected.size(), 2);
+
+    influx::ParallelQuery options;
+    options.splits = 7;
+    options.hedgeQuantile = 0.5;
+    const auto tables = db.Query(flux, start, stop, options);
+
+    ASSERT_EQ(tables.size(), expected.size());
+    for (std::size_t i = 0; i < tables.size(); i++) {
+        ASSERT_EQ(tables[i].size(), expected[i].size());
+        for (std::size_t j = 0; j < tables[i].size(); j++) {
+            EXPECT_EQ(tables[i][j].time, expected[i][j].time);
+            EXPECT_EQ(tables[i][j].value, expected[i][j].value);
+            EXPECT_EQ(tables[i][j].tags, expected[i][j].tags);
+            EXPECT_EQ(tables[i][j].start, expected[i][j].start);
+            EXPECT_EQ(tables[i][j].stop, expected[i][j].stop);
+        }
+    }
+
+    EXPECT_THROW(db.Query("buckets()", start, stop, options), influx::InfluxError);
+    EXPECT_THROW(db.Query(flux, stop, start, options), influx::InfluxError);
+    EXPECT_THROW(db.Query(flux, start, start, options), influx::InfluxError);
+
+    // More splits than clock ticks: one tick per sub-range
+    options.splits = 100;
+    EXPECT_NO_THROW(db.Query(flux, start, start + influx::Timestamp::duration(3), options));
+}
+
+TEST_F(InfluxTest, should_export_query_as_it_streams)
+{
+    auto name = influx::test::nowstring();
+    auto bucket = db.CreateBucket(name, 1h);
+    auto now = influx::Timestamp(std::chrono::duration_cast<std::chrono::seconds>((influx::Clock::now() - 15s).time_since_epoch()));
+
+    bucket
+        << (influx::Measurement("acquisition", now +  0s) << influx::Field("x", 20.5) << influx::Field("n", 3) << influx::Tag("domain", "1 a"))
+        << (influx::Measurement("acquisition", now +  5s) << influx::Field("x", 10.0) << influx::Field("n", 4) << influx::Tag("domain", "1 a"))
+        << (influx::Measurement("status",      now + 10s) << influx::Field("ok", true) << influx::Field("msg", "all \"good\""));
+    bucket.Flush();
+
+    const std::string flux = R"~(
+        from(bucket: ")~" + name + R"~(")
+            |> range(start: -20s)
+    )~";
+
+    std::string csv;
+    std::size_t pieces = 0;
+    db.Export(flux, [&](std::string_view data) {
+        csv.append(data);
+        pieces++;
+    });
+    EXPECT_GT(pieces, 0);
+    EXPECT_TRUE(csv.starts_with("#datatype"));
+
+    std::size_t rows = 0;
+    for (std::size_t pos = csv.find("\n,_result,"); pos != std::string::npos; pos = csv.find("\n,_result,", pos + 1)) {
+        rows++;
+    }
+    EXPECT_EQ(rows, 6);
+
+    std::stringstream lines;
+    db.Export(flux, lines, influx::ExportFormat::LineProtocol);
+
+    std::set<std::string> expected;
+    for (auto measurement: {
+        (influx::Measurement("acquisition", now +  0s) << influx::Field("n", 3) << influx::Tag("domain", "1 a")),
+        (influx::Measurement("acquisition", now +  5s) << influx::Field("n", 4) << influx::Tag("domain", "1 a")),
+        (influx::Measurement("acquisition", now +  0s) << influx::Field("x", 20.5) << influx::Tag("domain", "1 a")),
+        (influx::Measurement("acquisition", now +  5s) << influx::Field("x", 10.0) << influx::Tag("domain", "1 a")),
+        (influx::Measurement("status",      now + 10s) << influx::Field("msg", "all \"good\"")),
+        (influx::Measurement("status",      now + 10s) << influx::Field("ok", true))
+    }) {
+        std::stringstream ss;
+        ss << measurement;
+        expected.insert(ss.str());
+    }
+
+    std::set<std::string> exported;
+    for (std::string line; std::getline(lines, line);) {
+        exported.insert(line);
+    }
+    EXPECT_EQ(exported, expected);
+
+    EXPECT_THROW(db.Export(flux, [](std::string_view) { throw std::runtime_error("full"); }), std::runtime_error);
+}
+
+#if !defined(_WIN32)
+TEST(RequestOptionsTest, should_time_out_unanswered_requests)
+{
+    SilentServer server;
+    influx::Influx db(server.host(), "org", "token");
+
+    influx::RequestOptions options;
+    options.timeout = 100ms;
+    db.SetRequestOptions(options);
+    EXPECT_EQ(db.requestOptions().timeout, 100ms);
+
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(db.QueryRaw("buckets()"), influx::TimeoutError);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+
+    // The innermost scope wins over client defaults
+    options.timeout = 10s;
+    db.SetRequestOptions(options);
+    {
+        influx::RequestScope scope({.timeout = 100ms});
+        EXPECT_THROW(db.QueryRaw("buckets()"), influx::TimeoutError);
+    }
+}
+
+TEST(RequestOptionsTest, should_cancel_requests_from_another_thread)
+{
+    SilentServer server;
+    influx::Influx db(server.host(), "org", "token");
+
+    influx::CancellationToken token;
+    std::thread canceller([token]() mutable {
+        std::this_thread::sleep_for(100ms);
+        token.Cancel();
+    });
+
+    {
+        influx::RequestScope scope({.cancellation = token});
+        EXPECT_THROW(db.QueryRaw("buckets()"), influx::CancelledError);
+    }
+    canceller.join();
+    EXPECT_TRUE(token.cancelled());
+
+    // Failures other than timeouts carry curl's description
+    influx::Influx unreachable("http://127.0.0.1:1", "org", "token");
+    try {
+        unreachable.QueryRaw("buckets()");
+        EXPECT_TRUE(false);
+    } catch (const influx::InfluxError& e) {
+        EXPECT_STRNE(e.what(), "");
+    }
 }
+#endif
 
 TEST(InitInfluxTest, should_throw_if_invalid_token_passed)
 {
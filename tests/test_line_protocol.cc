@@ -0,0 +1,132 @@
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include <influx/line_protocol_parser.hh>
+#include <influx/measurement.hh>
+
+using namespace std::chrono_literals;
+
+namespace {
+    std::string Roundtrip(const std::string& input)
+    {
+        influx::LineProtocolParser parser(input);
+        std::stringstream ss;
+
+        while (influx::PointView* point = parser.Next()) {
+            ss << influx::Measurement(*point) << "\n";
+        }
+        return ss.str();
+    }
+}
+
+TEST(LineProtocolTest, should_parse_points)
+{
+    const std::string input =
+        "# comment\n"
+        "cpu,host=a,region=eu user=1.5,count=3i,big=18446744073709551615u,up=t,msg=\"ok\" 1000000000\n"
+        "\n"
+        "   mem free=false\r\n";
+
+    influx::LineProtocolParser parser(input);
+
+    influx::PointView* point = parser.Next();
+    ASSERT_NE(point, nullptr);
+    EXPECT_EQ(parser.line(), 2);
+    EXPECT_EQ(point->name(), "cpu");
+    ASSERT_EQ(point->tags().size(), 2);
+    EXPECT_EQ(point->tags()[1].key, "region");
+    EXPECT_EQ(point->tags()[1].value, "eu");
+    ASSERT_EQ(point->fields().size(), 5);
+    EXPECT_EQ(std::get<double>(point->fields()[0].value), 1.5);
+    EXPECT_EQ(std::get<std::int64_t>(point->fields()[1].value), 3);
+    EXPECT_EQ(std::get<std::uint64_t>(point->fields()[2].value), 18446744073709551615ull);
+    EXPECT_EQ(std::get<bool>(point->fields()[3].value), true);
+    EXPECT_EQ(std::get<std::string_view>(point->fields()[4].value), "ok");
+    EXPECT_EQ(point->timestamp(), influx::Timestamp(1s));
+
+    point = parser.Next();
+    ASSERT_NE(point, nullptr);
+    EXPECT_EQ(parser.line(), 4);
+    EXPECT_EQ(point->name(), "mem");
+    EXPECT_EQ(std::get<bool>(point->fields()[0].value), false);
+    EXPECT_EQ(point->timestamp(), influx::NoTimestamp);
+
+    EXPECT_EQ(parser.Next(), nullptr);
+}
+
+TEST(LineProtocolTest, should_parse_points_with_many_fields)
+{
+    std::string line = "kernel_vmstat,host=a ";
+    for (int i = 0; i < 40; i++) {
+        line += (i ? ",f" : "f") + std::to_string(i) + "=" + std::to_string(i) + "i";
+    }
+    line += " 1000000000\n";
+
+    const std::string input = line + "mem f0=1i\n" + line;
+
+    influx::LineProtocolParser parser(input);
+    for (std::size_t expected: {40, 1, 40}) {
+        influx::PointView* point = parser.Next();
+        ASSERT_NE(point, nullptr);
+        ASSERT_EQ(point->fields().size(), expected);
+        EXPECT_EQ(point->fields().back().key, "f" + std::to_string(expected - 1));
+    }
+}
+
+TEST(LineProtocolTest, should_unescape_and_roundtrip_special_characters)
+{
+    const std::string input = R"(my\ cpu,key\=1=value\ 1,key\,2=🚀 field2="\"a\" is different from \"\\\"",field\ 1=-2.5e-3 1000000000)" "\n";
+
+    influx::LineProtocolParser parser(input);
+    influx::PointView* point = parser.Next();
+    ASSERT_NE(point, nullptr);
+    EXPECT_EQ(point->name(), "my cpu");
+    EXPECT_EQ(point->tags()[0].key, "key=1");
+    EXPECT_EQ(point->tags()[0].value, "value 1");
+    EXPECT_EQ(std::get<std::string_view>(point->fields()[0].value), R"("a" is different from "\")");
+    EXPECT_EQ(point->fields()[1].key, "field 1");
+    EXPECT_EQ(std::get<double>(point->fields()[1].value), -2.5e-3);
+
+    EXPECT_EQ(Roundtrip(input), R"(my\ cpu,key\,2=🚀,key\=1=value\ 1 field\ 1=-0.0025,field2="\"a\" is different from \"\\\"" 1000000000)" "\n");
+}
+
+TEST(LineProtocolTest, should_report_malformed_lines)
+{
+    for (const char* input: {"cpu", "cpu,host a=1", "cpu,host= a=1", "cpu a", "cpu a=\"open", "cpu a=1x", "cpu a=1i 12ab", ",a=1 b=1", "cpu _a=1", "cpu a=9223372036854775808i", "cpu a=-1u", "cpu a=inf", "cpu a=-Infinity", "cpu a=nan", "cpu a=0x1p3", "cpu a=1e400"}) {
+        const std::string lines = std::string("m a=1\n") + input;
+        influx::LineProtocolParser parser(lines);
+        EXPECT_NE(parser.Next(), nullptr);
+
+        try {
+            parser.Next();
+            ADD_FAILURE() << "accepted: " << input;
+        } catch (influx::LineProtocolError& e) {
+            EXPECT_EQ(e.line(), 2) << input;
+        }
+    }
+}
+
+TEST(LineProtocolTest, should_parse_numeric_limits)
+{
+    influx::LineProtocolParser parser("m a=-9223372036854775808i,b=0.1,c=-0,d=123456789.0123456789,e=1e300 -1000");
+
+    influx::PointView* point = parser.Next();
+    ASSERT_NE(point, nullptr);
+    EXPECT_EQ(std::get<std::int64_t>(point->fields()[0].value), std::numeric_limits<std::int64_t>::min());
+    EXPECT_EQ(std::get<double>(point->fields()[1].value), 0.1);
+    EXPECT_EQ(std::get<double>(point->fields()[2].value), 0.0);
+    EXPECT_EQ(std::get<double>(point->fields()[3].value), 123456789.0123456789);
+    EXPECT_EQ(std::get<double>(point->fields()[4].value), 1e300);
+    EXPECT_EQ(point->timestamp(), influx::Timestamp(-1000ns));
+}
+
+TEST(LineProtocolTest, should_resume_after_malformed_line)
+{
+    influx::LineProtocolParser parser("cpu\nmem a=1\n");
+    EXPECT_THROW(parser.Next(), influx::LineProtocolError);
+
+    influx::PointView* point = parser.Next();
+    ASSERT_NE(point, nullptr);
+    EXPECT_EQ(point->name(), "mem");
+}
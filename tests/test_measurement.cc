@@ -1,4 +1,6 @@
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -37,6 +39,63 @@ TEST(MeasurementTest, should_escape_characters_correctly)
 
     std::string expected = R"(my\ measurement,key\,2=🚀,key\=1=value\ 1 field2="\"a\" is different from \"\\\"" 1000000000)";
     EXPECT_EQ(ss.str(), expected);
+
+    // NUL is not one of the characters to escape
+    ss.str("");
+    ss << (influx::Measurement("m", influx::Timestamp(1000ms)) << influx::Field{"field1", std::string("a\0b", 3)});
+    EXPECT_EQ(ss.str(), std::string("m field1=\"a\0b\" 1000000000", 25));
+}
+
+TEST(MeasurementTest, should_output_doubles_without_loss_of_precision)
+{
+    influx::Measurement m("m", influx::Timestamp(1000ms));
+    m << influx::Field{"pi", 3.141592653589793} << influx::Field{"big", 1e21} << influx::Field{"tenth", 0.1};
+
+    std::stringstream ss;
+    ss << m;
+
+    EXPECT_EQ(ss.str(), "m big=1e+21,pi=3.141592653589793,tenth=0.1 1000000000");
+}
+
+TEST(MeasurementTest, should_omit_unset_timestamp)
+{
+    std::stringstream ss;
+    ss << (influx::Measurement("m", influx::NoTimestamp) << influx::Field{"field1", 1});
+
+    EXPECT_EQ(ss.str(), "m field1=1i");
+}
+
+TEST(MeasurementTest, should_take_default_timestamp_from_selected_source)
+{
+    for (auto source: {influx::TimestampSource::Coarse, influx::TimestampSource::Cached, influx::TimestampSource::System}) {
+        influx::SetTimestampSource(source);
+        EXPECT_EQ(influx::timestampSource(), source);
+
+        const auto before = influx::Clock::now();
+        influx::Measurement m("m");
+        EXPECT_LT(std::chrono::abs(m.timestamp() - before), 100ms);
+    }
+}
+
+TEST(MeasurementTest, should_switch_timestamp_source_from_several_threads)
+{
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; i++) {
+        threads.emplace_back([]() {
+            for (int j = 0; j < 200; j++) {
+                influx::SetTimestampSource(j % 2 ? influx::TimestampSource::System : influx::TimestampSource::Cached);
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    // Whichever thread came last, the ticker follows
+    influx::SetTimestampSource(influx::TimestampSource::Cached);
+    std::this_thread::sleep_for(50ms);
+    EXPECT_LT(std::chrono::abs(influx::Now() - influx::Clock::now()), 20ms);
+    influx::SetTimestampSource(influx::TimestampSource::System);
 }
 
 TEST(MeasurementTest, should_throw_if_trying_to_output_empty_measurement)
@@ -110,3 +169,36 @@ TEST(MeasurementTest, should_be_comparable)
         (influx::Measurement("b", influx::Timestamp(1000ms)) << influx::Field{"d", 1} << influx::Tag{"e", "val"})
     );
 }
+
+TEST(MeasurementTest, should_be_reusable)
+{
+    influx::Measurement m("a", influx::Timestamp(1000ms));
+    m.SetTag("host", "a-rather-long-host-name");
+    m.SetField("status", std::string("a rather long status message"));
+    m.SetField("value", 1.5);
+    m.SetField("value", 2.5);
+    EXPECT_EQ(m, (influx::Measurement("a", influx::Timestamp(1000ms))
+        << influx::Tag{"host", "a-rather-long-host-name"}
+        << influx::Field{"status", std::string("a rather long status message")}
+        << influx::Field{"value", 2.5}));
+
+    const char* tagStorage = m.tags().begin()->value.data();
+    const char* fieldStorage = std::get<std::string>(m.fields().begin()->value).data();
+
+    m.Reset("b", influx::Timestamp(2000ms));
+    EXPECT_EQ(m, influx::Measurement("b", influx::Timestamp(2000ms)));
+
+    m.SetTag("host", "another-long-host-name");
+    m.SetField("status", std::string_view("another long status message"));
+    EXPECT_EQ(m.tags().begin()->value, "another-long-host-name");
+    EXPECT_EQ(m.tags().begin()->value.data(), tagStorage);
+    EXPECT_EQ(std::get<std::string>(m.fields().begin()->value), "another long status message");
+    EXPECT_EQ(std::get<std::string>(m.fields().begin()->value).data(), fieldStorage);
+
+    m.SetField("value", 1.5);
+    m.SetField("value", "a string now");
+    EXPECT_EQ(std::get<std::string>(std::next(m.fields().begin())->value), "a string now");
+
+    EXPECT_THROW(m.SetTag("", "value"), influx::InvalidMeasurementError);
+    EXPECT_THROW(m.SetField("_field", 1.0), influx::InvalidMeasurementError);
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include "config.hh"
+
+#include <influx/influx.hh>
+#include <influx/query_cache.hh>
+
+using namespace std::chrono_literals;
+
+class QueryCacheTest: public ::testing::Test {
+protected:
+    influx::Influx db = influx::test::db();
+    std::string name = influx::test::nowstring();
+    influx::Bucket bucket = db.CreateBucket(name, 1h);
+    influx::Timestamp origin = influx::Clock::now() - 10min;
+
+    std::string flux = R"~(
+        from(bucket: ")~" + name + R"~(")
+            |> range(start: v.timeRangeStart, stop: v.timeRangeStop)
+            |> filter(fn: (r) => r._field == "x")
+    )~";
+
+    void TearDown() override
+    {
+        auto buckets = db.ListBuckets();
+        for (auto& bucket: buckets) {
+            if (!bucket.is_system_bucket()) {
+                db.DeleteBucket(bucket);
+            }
+        }
+    }
+
+    void write(int minute, double value, const std::string& host)
+    {
+        bucket << (influx::Measurement("m", origin + minute * 1min) << influx::Field("x", value) << influx::Tag("host", host));
+        bucket.Flush();
+    }
+
+    static std::size_t count(const std::vector<influx::FluxTable>& tables)
+    {
+        std::size_t records = 0;
+        for (const auto& table: tables) {
+            records += table.size();
+        }
+        return records;
+    }
+};
+
+TEST_F(QueryCacheTest, should_return_same_result_as_query)
+{
+    write(1, 1.0, "a");
+    write(2, 2.0, "b");
+
+    influx::QueryCache cache(db);
+    auto cached = cache.Query(flux, origin, origin + 5min);
+    auto direct = db.Query(flux, origin, origin + 5min);
+
+    ASSERT_EQ(cached.size(), direct.size());
+    EXPECT_EQ(count(cached), 2);
+    EXPECT_EQ(cache.size(), 1);
+}
+
+TEST_F(QueryCacheTest, should_only_query_tail_when_window_slides)
+{
+    write(1, 1.0, "a");
+    write(2, 2.0, "a");
+
+    influx::QueryCache cache(db);
+    auto tables = cache.Query(flux, origin, origin + 3min);
+    ASSERT_EQ(tables.size(), 1);
+    ASSERT_EQ(tables[0].size(), 2);
+
+    // Lands in the cached interval, so it is not seen until the cache is cleared
+    write(0, 0.5, "a");
+    write(4, 4.0, "a");
+    write(4, 4.0, "b");
+
+    tables = cache.Query(flux, origin + 2min, origin + 5min);
+    ASSERT_EQ(tables.size(), 2);
+    ASSERT_EQ(tables[0].size(), 2);
+    EXPECT_EQ(std::get<double>(tables[0][0].value), 2.0);
+    EXPECT_EQ(std::get<double>(tables[0][1].value), 4.0);
+    EXPECT_EQ(tables[0][0].start, origin + 2min);
+    EXPECT_EQ(tables[0][1].stop, origin + 5min);
+    EXPECT_EQ(tables[1][0].tags.at("host"), "b");
+
+    cache.Clear();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(count(cache.Query(flux, origin, origin + 5min)), 5);
+}
+
+TEST_F(QueryCacheTest, should_throw_on_empty_range)
+{
+    influx::QueryCache cache(db);
+
+    try {
+        cache.Query(flux, origin, origin);
+        EXPECT_TRUE(false);
+    } catch (influx::InfluxError& e) {
+        EXPECT_STREQ(e.what(), "Query range stop must be after its start");
+    }
+}
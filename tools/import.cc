@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <influx/influx.hh>
+
+namespace {
+    const char* const USAGE =
+        "usage: influx-import --host URL --org ORG_ID --bucket NAME [options] FILE...\n"
+        "\n"
+        "Post line protocol files (precision=ns) to an InfluxDB v2 bucket.\n"
+        "\n"
+        "  --token TOKEN       API token, defaults to $INFLUX_TOKEN\n"
+        "  --batch-bytes N     Upper bound on each request body (default 8388608)\n"
+        "  --concurrency N     Requests in flight (default 4)\n"
+        "  --gzip-level N      Compression level 1-9, 0 to disable (default 1)\n";
+
+    std::size_t ParseSize(const char* value)
+    {
+        char* end;
+        unsigned long long parsed = std::strtoull(value, &end, 10);
+        if (*value == '\0' || *end != '\0') {
+            throw std::invalid_argument(std::string("not a number: ") + value);
+        }
+        return static_cast<std::size_t>(parsed);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string host, org, bucketName;
+    std::string token = std::getenv("INFLUX_TOKEN") ? std::getenv("INFLUX_TOKEN") : "";
+    std::vector<std::string> files;
+    influx::ImportOptions options;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+
+            auto value = [&]() -> const char* {
+                if (i + 1 == argc) {
+                    throw std::invalid_argument("missing value for " + arg);
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--help" || arg == "-h") {
+                std::cout << USAGE;
+                return 0;
+            } else if (arg == "--host") {
+                host = value();
+            } else if (arg == "--org") {
+                org = value();
+            } else if (arg == "--token") {
+                token = value();
+            } else if (arg == "--bucket") {
+                bucketName = value();
+            } else if (arg == "--batch-bytes") {
+                options.batchBytes = ParseSize(value());
+            } else if (arg == "--concurrency") {
+                options.concurrency = ParseSize(value());
+            } else if (arg == "--gzip-level") {
+                options.compressionLevel = static_cast<int>(ParseSize(value()));
+            } else if (arg.starts_with("--")) {
+                throw std::invalid_argument("unknown option " + arg);
+            } else {
+                files.push_back(arg);
+            }
+        }
+
+        if (host.empty() || org.empty() || bucketName.empty() || files.empty()) {
+            throw std::invalid_argument("missing required argument");
+        }
+    } catch (std::invalid_argument& e) {
+        std::cerr << "influx-import: " << e.what() << "\n\n" << USAGE;
+        return 2;
+    }
+
+    try {
+        influx::Influx db(host, org, token);
+        influx::Bucket bucket = db.GetBucketByName(bucketName);
+
+        if (!bucket) {
+            std::cerr << "influx-import: no bucket named " << bucketName << "\n";
+            return 1;
+        }
+
+        for (const std::string& file: files) {
+            const auto start = std::chrono::steady_clock::now();
+            const influx::ImportStats stats = bucket.Import(file, options);
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            std::cout << file << ": " << stats.bytes << " bytes in " << stats.requests << " requests ("
+                      << stats.sentBytes << " bytes sent), " << elapsed.count() << " s, "
+                      << static_cast<double>(stats.bytes) / 1e6 / std::max(elapsed.count(), 1e-9) << " MB/s\n";
+        }
+    } catch (std::exception& e) {
+        std::cerr << "influx-import: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <influx/line_protocol_parser.hh>
+
+namespace {
+    const char* const USAGE =
+        "usage: influx-parse-bench [--rounds N] [FILE]\n"
+        "\n"
+        "Measure single-core LineProtocolParser throughput over FILE, or over a\n"
+        "generated telegraf-like input when none is given.\n"
+        "\n"
+        "  --rounds N          Passes over the input (default 20)\n";
+
+    std::string Generate()
+    {
+        std::string input;
+
+        for (int i = 0; i < 200000; i++) {
+            input += "cpu,host=server-" + std::to_string(i % 64) + ",region=eu-west,cpu=cpu" + std::to_string(i % 8);
+            input += " usage_user=" + std::to_string(i % 100) + ".25,usage_system=3.5,usage_idle=" + std::to_string(90 + i % 10);
+            input += ",processes=" + std::to_string(i) + "i,state=\"running\",online=t ";
+            input += std::to_string(1600000000000000000ll + i * 10000000ll) + "\n";
+        }
+        return input;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string file;
+    long rounds = 20;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+
+        if (arg == "--help" || arg == "-h") {
+            std::cout << USAGE;
+            return 0;
+        } else if (arg == "--rounds" && i + 1 < argc) {
+            rounds = std::max(1l, std::strtol(argv[++i], nullptr, 10));
+        } else if (arg.starts_with("-")) {
+            std::cerr << "influx-parse-bench: unknown option " << arg << "\n\n" << USAGE;
+            return 2;
+        } else {
+            file = arg;
+        }
+    }
+
+    std::string input;
+    if (file.empty()) {
+        input = Generate();
+    } else {
+        std::ifstream in(file, std::ios::binary);
+        if (!in) {
+            std::cerr << "influx-parse-bench: cannot open " << file << "\n";
+            return 1;
+        }
+        std::stringstream ss;
+        ss << in.rdbuf();
+        input = ss.str();
+    }
+
+    std::size_t points = 0, errors = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (long round = 0; round < rounds; round++) {
+        influx::LineProtocolParser parser(input);
+
+        for (;;) {
+            try {
+                if (!parser.Next()) {
+                    break;
+                }
+                points++;
+            } catch (influx::LineProtocolError&) {
+                errors++;
+            }
+        }
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const double bytes = static_cast<double>(input.size()) * static_cast<double>(rounds);
+
+    std::cout << points << " points (" << errors << " malformed lines), " << bytes / 1e6 << " MB in "
+              << elapsed.count() << " s, " << bytes / 1e6 / std::max(elapsed.count(), 1e-9) << " MB/s\n";
+    return 0;
+}